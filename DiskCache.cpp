@@ -0,0 +1,309 @@
+#include "DiskCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char MAGIC[8] = { 'N', 'O', 'D', 'E', 'C', 'A', 'C', 'H' };
+const uint32_t FORMAT_VERSION = 1;
+const char* EXTENSION = ".nodecache";
+
+// Pixels start 64 bytes into the (page-aligned) mapping, so rows stay aligned for SIMD
+struct Header {
+    char magic[8];
+    uint32_t version;
+    int32_t rows, cols, type;
+    uint64_t dataBytes;
+    char reserved[32];
+};
+static_assert(sizeof(Header) == 64, "cache file header must stay 64 bytes");
+
+struct Mapping {
+    void* base;
+    size_t length;
+};
+
+void unmap(Mapping* mapping) {
+#ifdef _WIN32
+    UnmapViewOfFile(mapping->base);
+#else
+    munmap(mapping->base, mapping->length);
+#endif
+    delete mapping;
+}
+
+// Owner of Mats that view a mapped file: when the last reference goes, the
+// file is unmapped. Buffers created through a Mat that has it as allocator
+// come from OpenCV's default allocator, which then owns them.
+class MappedAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const override {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) return;
+        unmap(static_cast<Mapping*>(u->userdata));
+        delete u;
+    }
+
+    static MappedAllocator& instance() {
+        static MappedAllocator allocator;
+        return allocator;
+    }
+};
+
+// Whole file, private and writable; nullptr on failure
+Mapping* mapFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    void* base = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping) {
+            base = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            CloseHandle(mapping);  // The view keeps the mapping alive
+        }
+    }
+    CloseHandle(file);
+    return base ? new Mapping{ base, static_cast<size_t>(size.QuadPart) } : nullptr;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        base = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    return base != MAP_FAILED ? new Mapping{ base, static_cast<size_t>(info.st_size) } : nullptr;
+#endif
+}
+
+std::string hex(const CacheKey& key) {
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx", static_cast<unsigned long long>(key.high),
+                  static_cast<unsigned long long>(key.low));
+    return text;
+}
+
+} // namespace
+
+DiskCache::DiskCache(const std::string& directory, size_t budgetBytes)
+    : root(directory), budget(budgetBytes) {
+    std::error_code error;
+    fs::create_directories(root, error);
+    open = fs::is_directory(root, error);
+    if (!open) return;
+
+    for (const auto& entry : fs::directory_iterator(root, error)) {
+        if (entry.is_regular_file(error) && entry.path().extension() == EXTENSION)
+            stored += static_cast<size_t>(entry.file_size(error));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        trim();
+    }
+    writer = std::thread([this] { writerLoop(); });
+}
+
+DiskCache::~DiskCache() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queued.notify_all();
+    if (writer.joinable()) writer.join();
+}
+
+void DiskCache::storeAsync(const CacheKey& key, const cv::Mat& image) {
+    if (!open || image.empty()) return;
+    size_t bytes = image.total() * image.elemSize();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (pendingBytes + bytes > MAX_QUEUED_BYTES) return;
+        pending.emplace_back(key, image);
+        pendingBytes += bytes;
+    }
+    queued.notify_one();
+}
+
+void DiskCache::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    drained.wait(lock, [this] { return pending.empty() && !writing; });
+}
+
+void DiskCache::writerLoop() {
+    for (;;) {
+        std::pair<CacheKey, cv::Mat> job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queued.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            job = std::move(pending.front());
+            pending.pop_front();
+            writing = true;
+        }
+
+        store(job.first, job.second);
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pendingBytes -= job.second.total() * job.second.elemSize();
+        writing = false;
+        if (pending.empty())
+            drained.notify_all();
+    }
+}
+
+std::string DiskCache::pathOf(const CacheKey& key) const {
+    static const CacheKey version = CacheKey::of("results " + std::to_string(RESULTS_VERSION));
+    CacheKey versioned = key;
+    versioned.combine(version);
+    return (fs::path(root) / (hex(versioned) + EXTENSION)).string();
+}
+
+bool DiskCache::contains(const CacheKey& key) const {
+    std::error_code error;
+    return open && fs::exists(pathOf(key), error);
+}
+
+cv::Mat DiskCache::load(const CacheKey& key) {
+    std::string path = pathOf(key);
+    Mapping* mapping = open ? mapFile(path) : nullptr;
+
+    cv::Mat image;
+    if (mapping) {
+        Header header;
+        bool valid = mapping->length >= sizeof(Header);
+        if (valid) {
+            std::memcpy(&header, mapping->base, sizeof(Header));
+            valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == FORMAT_VERSION
+                 && header.rows > 0 && header.cols > 0
+                 && header.dataBytes == uint64_t(header.rows) * header.cols * CV_ELEM_SIZE(header.type)
+                 && mapping->length >= sizeof(Header) + header.dataBytes;
+        }
+
+        if (valid) {
+            uchar* data = static_cast<uchar*>(mapping->base) + sizeof(Header);
+            image = cv::Mat(header.rows, header.cols, header.type, data);
+            cv::UMatData* u = new cv::UMatData(&MappedAllocator::instance());
+            u->data = u->origdata = data;
+            u->size = static_cast<size_t>(header.dataBytes);
+            u->userdata = mapping;
+            u->refcount = 1;  // Held by `image`
+            image.u = u;
+            image.allocator = &MappedAllocator::instance();
+
+            std::error_code error;
+            fs::last_write_time(path, fs::file_time_type::clock::now(), error);  // Recently used
+        } else {
+            unmap(mapping);
+            std::error_code error;
+            fs::remove(path, error);  // Truncated or from another format version
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (image.empty()) ++missCount;
+    else ++hitCount;
+    return image;
+}
+
+bool DiskCache::store(const CacheKey& key, const cv::Mat& image) {
+    if (!open || image.empty() || image.dims > 2) return false;
+    std::string path = pathOf(key);
+    std::error_code error;
+    if (fs::exists(path, error)) return true;  // Same key, same content
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.rows = image.rows;
+    header.cols = image.cols;
+    header.type = image.type();
+    const size_t rowBytes = image.cols * image.elemSize();
+    header.dataBytes = uint64_t(rowBytes) * image.rows;
+
+    // Concurrent writers of the same key each use their own temporary file
+    std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream out(temp, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int y = 0; y < image.rows && out; ++y)
+            out.write(reinterpret_cast<const char*>(image.ptr(y)), static_cast<std::streamsize>(rowBytes));
+        if (!out) {
+            out.close();
+            fs::remove(temp, error);
+            return false;
+        }
+    }
+    fs::rename(temp, path, error);
+    if (error) {
+        fs::remove(temp, error);
+        return fs::exists(path, error);  // Another writer may have got there first
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++writeCount;
+    stored += sizeof(Header) + static_cast<size_t>(header.dataBytes);
+    trim();
+    return true;
+}
+
+void DiskCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = bytes;
+    trim();
+}
+
+void DiskCache::trim() {
+    if (budget == 0 || stored <= budget) return;
+
+    struct File {
+        fs::file_time_type time;
+        size_t size;
+        fs::path path;
+    };
+    std::vector<File> files;
+    std::error_code error;
+    stored = 0;
+    for (const auto& entry : fs::directory_iterator(root, error)) {
+        if (!entry.is_regular_file(error) || entry.path().extension() != EXTENSION) continue;
+        File file{ entry.last_write_time(error), static_cast<size_t>(entry.file_size(error)), entry.path() };
+        stored += file.size;
+        files.push_back(file);
+    }
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+
+    // Mapped files stay readable after removal on POSIX; Windows refuses and they are retried later
+    for (const File& file : files) {
+        if (stored <= budget) break;
+        if (fs::remove(file.path, error)) stored -= file.size;
+    }
+}
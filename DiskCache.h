@@ -0,0 +1,88 @@
+#pragma once
+#include "OutputCache.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <opencv2/core.hpp>
+
+// Node results on disk, keyed by the same CacheKey as the in-memory cache,
+// so a restarted session or batch job picks up where the last one stopped.
+// Each result is one file: a 64-byte header (magic, shape, type) followed
+// by the raw pixels, which load() maps into memory instead of reading.
+// Mappings are private (copy-on-write): a node writing into a loaded image
+// in place never changes the file. Files past the byte budget are deleted
+// oldest first; a budget of 0 means no limit. Thread-safe, and one cache
+// can be shared by several engines.
+class DiskCache {
+public:
+    // Part of every file's key. Keys only describe a node's type, parameters
+    // and inputs, so bump this whenever a node computes differently (kernel
+    // widths, LUT rounding, ...) and results of older builds stop matching.
+    static const unsigned RESULTS_VERSION = 1;
+
+    explicit DiskCache(const std::string& directory, size_t budgetBytes = 0);
+
+    // Writes everything still queued before returning
+    ~DiskCache();
+
+    DiskCache(const DiskCache&) = delete;
+    DiskCache& operator=(const DiskCache&) = delete;
+
+    // False if the directory could not be created
+    bool isOpen() const { return open; }
+    const std::string& directory() const { return root; }
+
+    // Mapped result, or an empty Mat if there is none (or the file is damaged)
+    cv::Mat load(const CacheKey& key);
+
+    // Write atomically (temporary file, then rename); false on I/O errors
+    bool store(const CacheKey& key, const cv::Mat& image);
+
+    // store() on the cache's writer thread, so callers don't wait for the
+    // disk. The queue shares the image: callers must not write into its
+    // buffer afterwards. While more than MAX_QUEUED_BYTES are waiting, new
+    // results are skipped rather than queued; it is only a cache.
+    void storeAsync(const CacheKey& key, const cv::Mat& image);
+
+    // Block until every queued write has finished
+    void flush();
+
+    static const size_t MAX_QUEUED_BYTES = size_t(256) << 20;
+
+    bool contains(const CacheKey& key) const;
+
+    void setBudget(size_t bytes);
+
+    size_t budgetBytes() const { std::lock_guard<std::mutex> lock(mutex); return budget; }
+    size_t storedBytes() const { std::lock_guard<std::mutex> lock(mutex); return stored; }
+    size_t hits() const { std::lock_guard<std::mutex> lock(mutex); return hitCount; }
+    size_t misses() const { std::lock_guard<std::mutex> lock(mutex); return missCount; }
+    size_t writes() const { std::lock_guard<std::mutex> lock(mutex); return writeCount; }
+
+private:
+    std::string root;
+    bool open = false;
+    mutable std::mutex mutex;
+    size_t budget;
+    size_t stored = 0;             // Bytes in the directory, as of the last scan plus writes
+    size_t hitCount = 0, missCount = 0, writeCount = 0;
+
+    std::mutex queueMutex;
+    std::condition_variable queued, drained;
+    std::deque<std::pair<CacheKey, cv::Mat>> pending;  // Guarded by queueMutex
+    size_t pendingBytes = 0;
+    bool writing = false;
+    bool stopping = false;
+    std::thread writer;
+
+    void writerLoop();
+
+    std::string pathOf(const CacheKey& key) const;
+
+    // Caller holds the mutex
+    void trim();
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include "Graph.h"
+#include "GraphEngine.h"
+#include "FrameReader.h"
+#include "nodes/ImageInputNode.h"
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Runs one graph over a stream with several frames in flight. Nodes keep
+// their results as members, so each frame in flight gets its own copy of
+// the graph (a lane) with its own engine: while one lane runs the
+// downstream nodes of frame N, the next has already started the upstream
+// nodes of frame N + 1. Frames are handed to the lanes in stream order and
+// delivered back in the same order.
+class FramePipeline {
+public:
+    using GraphFactory = std::function<std::unique_ptr<Graph>()>;
+    using FrameCallback = std::function<void(long index, Graph& graph)>;
+
+    struct Result {
+        size_t frames = 0;   // Frames taken from the reader, including failed ones
+        size_t failed = 0;
+    };
+
+    // `factory` builds one copy of the graph per lane; each copy's first
+    // ImageInput (or VideoInput) node receives the frames
+    FramePipeline(const GraphFactory& factory, unsigned lanes = 2, unsigned threadsPerLane = 1) {
+        if (lanes == 0) lanes = 1;
+        for (unsigned i = 0; i < lanes; ++i) {
+            auto lane = std::make_unique<Lane>(threadsPerLane);
+            lane->graph = factory();
+            lane->input = lane->graph->find<ImageInputNode>();
+            if (!lane->input)
+                throw std::runtime_error("FramePipeline: graph has no ImageInput node");
+            // Every frame recomputes the whole graph, so intermediates can go early
+            lane->engine.setReleaseIntermediates(true);
+            this->lanes.push_back(std::move(lane));
+        }
+    }
+
+    unsigned laneCount() const { return static_cast<unsigned>(lanes.size()); }
+
+    // Engine of each lane, e.g. to set tiling or turn on profiling
+    GraphEngine& engine(unsigned lane) { return lanes[lane]->engine; }
+
+    // Evaluate every frame `reader` delivers until the stream ends or
+    // `cancel` is raised. `prepare` runs on the lane before its frame is
+    // evaluated (lanes run it concurrently, e.g. to name outputs);
+    // `deliver` runs after, strictly in frame order. Node errors are
+    // reported and counted, and the stream carries on.
+    Result run(FrameReader& reader, const FrameCallback& prepare = FrameCallback(),
+               const FrameCallback& deliver = FrameCallback(), const CancellationToken* cancel = nullptr) {
+        Result result;
+        taken = delivered = 0;
+
+        std::vector<std::thread> threads;
+        for (auto& lane : lanes)
+            threads.emplace_back([&, raw = lane.get()] { runLane(*raw, reader, prepare, deliver, cancel, result); });
+        for (std::thread& t : threads)
+            t.join();
+        return result;
+    }
+
+private:
+    struct Lane {
+        explicit Lane(unsigned threads) : engine(threads) {}
+        std::unique_ptr<Graph> graph;
+        ImageInputNode* input = nullptr;
+        GraphEngine engine;
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::mutex takeMutex, orderMutex;
+    std::condition_variable turn;
+    size_t taken = 0;                  // Frames taken this run; guarded by takeMutex
+    size_t delivered = 0;              // Guarded by orderMutex
+
+    void runLane(Lane& lane, FrameReader& reader, const FrameCallback& prepare, const FrameCallback& deliver,
+                 const CancellationToken* cancel, Result& result) {
+        for (;;) {
+            // Number frames as they are taken so delivery order doesn't
+            // depend on where the reader's indices start
+            FrameReader::Frame frame;
+            size_t sequence;
+            {
+                std::lock_guard<std::mutex> lock(takeMutex);
+                if ((cancel && cancel->isCancelled()) || !reader.next(frame)) break;
+                sequence = taken++;
+            }
+            lane.input->setImage(frame.image, lane.input->getPath());
+
+            bool ok = true;
+            try {
+                if (prepare) prepare(frame.index, *lane.graph);
+                ok = lane.engine.execute(lane.graph->sinks, cancel);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                std::cerr << "[✘] frame " << frame.index << ": " << e.what() << std::endl;
+                ok = false;
+            }
+
+            // Wait for the previous frame to be delivered before handing this one on
+            std::unique_lock<std::mutex> lock(orderMutex);
+            turn.wait(lock, [&] { return delivered == sequence; });
+            ++result.frames;
+            if (!ok) ++result.failed;
+            lock.unlock();
+
+            if (ok && deliver) {
+                try {
+                    deliver(frame.index, *lane.graph);
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> errorLock(orderMutex);
+                    std::cerr << "[✘] frame " << frame.index << ": " << e.what() << std::endl;
+                    ++result.failed;
+                }
+            }
+
+            lock.lock();
+            ++delivered;
+            lock.unlock();
+            turn.notify_all();
+        }
+        // No point decoding ahead for a cancelled run
+        if (cancel && cancel->isCancelled()) reader.stop();
+    }
+};
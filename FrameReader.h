@@ -0,0 +1,114 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+// Background decode stage for video files and numbered image sequences
+// (printf-style patterns such as "frames/img_%04d.png", which OpenCV's
+// capture reads natively). A thread decodes ahead into a bounded ring, so
+// the graph never waits on the decoder unless it is outrunning it; once
+// the ring is full the decoder waits instead of buffering the whole file.
+class FrameReader {
+public:
+    struct Frame {
+        cv::Mat image;
+        long index = -1;   // Position in the stream, starting at 0
+    };
+
+    explicit FrameReader(const std::string& source, size_t ringSize = 4)
+        : capacity(ringSize > 0 ? ringSize : 1), capture(source) {
+        opened = capture.isOpened();
+        if (opened) {
+            framesPerSecond = capture.get(cv::CAP_PROP_FPS);
+            frames = static_cast<long>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+            decoder = std::thread([this] { decodeLoop(); });
+        } else {
+            finished = true;
+        }
+    }
+
+    ~FrameReader() {
+        stop();
+        if (decoder.joinable())
+            decoder.join();
+    }
+
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    bool isOpened() const { return opened; }
+
+    // As reported by the container; 0 when unknown (image sequences)
+    double fps() const { return framesPerSecond; }
+    long frameCount() const { return frames; }
+
+    // Next decoded frame, in stream order. Blocks while the decoder catches
+    // up; returns false at the end of the stream or after stop(). Safe to
+    // call from several threads, each getting different frames.
+    bool next(Frame& frame) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return !ring.empty() || finished; });
+        if (ring.empty()) return false;
+        frame = std::move(ring.front());
+        ring.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Stop decoding; frames already in the ring are dropped
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = finished = true;
+            ring.clear();
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+private:
+    const size_t capacity;
+    cv::VideoCapture capture;      // Only touched by the decoder thread once it runs
+    bool opened = false;
+    double framesPerSecond = 0;
+    long frames = 0;
+
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+    std::deque<Frame> ring;        // Guarded by mutex
+    bool finished = false;         // No more frames will be added
+    bool stopping = false;
+    std::thread decoder;
+
+    void decodeLoop() {
+        for (long index = 0;; ++index) {
+            // A fresh Mat per frame: earlier frames may still be in use downstream
+            Frame frame;
+            frame.index = index;
+            bool decoded = false;
+            try {
+                decoded = capture.read(frame.image) && !frame.image.empty();
+            } catch (const cv::Exception& e) {
+                std::cerr << "[✘] " << e.what() << std::endl;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!decoded || stopping) {
+                finished = true;
+                lock.unlock();
+                notEmpty.notify_all();
+                return;
+            }
+            notFull.wait(lock, [this] { return ring.size() < capacity || stopping; });
+            if (stopping) return;
+            ring.push_back(std::move(frame));
+            lock.unlock();
+            notEmpty.notify_one();
+        }
+    }
+};
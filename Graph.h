@@ -0,0 +1,76 @@
+#pragma once
+#include "nodes/Node.h"
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Owns the nodes of one processing pipeline and remembers which of them are
+// the sinks to evaluate. Nodes still reference each other through raw
+// `inputs` pointers, which stay valid for the Graph's lifetime.
+class Graph {
+public:
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<Node*> sinks;
+
+    template <typename T, typename... Args>
+    T* add(Args&&... args) {
+        auto node = std::make_unique<T>(std::forward<Args>(args)...);
+        T* raw = node.get();
+        nodes.push_back(std::move(node));
+        return raw;
+    }
+
+    // First node of the given type, or nullptr
+    template <typename T>
+    T* find() const {
+        for (const auto& node : nodes) {
+            if (T* typed = dynamic_cast<T*>(node.get()))
+                return typed;
+        }
+        return nullptr;
+    }
+
+    // Independent copy for another worker: every node cloned and wired the
+    // same way, with no results. Throws std::runtime_error if a node can't
+    // be cloned or has an input outside the graph.
+    std::unique_ptr<Graph> clone() const {
+        auto copy = std::make_unique<Graph>();
+        std::unordered_map<const Node*, Node*> twins;
+        for (const auto& node : nodes) {
+            std::unique_ptr<Node> twin = node->clone();
+            if (!twin)
+                throw std::runtime_error("Graph::clone: node '" + node->name + "' can't be cloned");
+            twin->releaseOutput();
+            twins[node.get()] = twin.get();
+            copy->nodes.push_back(std::move(twin));
+        }
+
+        auto twinOf = [&twins](const Node* node) {
+            auto it = twins.find(node);
+            if (it == twins.end())
+                throw std::runtime_error("Graph::clone: input outside the graph");
+            return it->second;
+        };
+        for (auto& node : copy->nodes) {
+            for (Node*& input : node->inputs) {
+                if (input) input = twinOf(input);
+            }
+        }
+        for (Node* sink : sinks)
+            copy->sinks.push_back(twinOf(sink));
+        return copy;
+    }
+
+    // Every node of the given type, in insertion order
+    template <typename T>
+    std::vector<T*> findAll() const {
+        std::vector<T*> found;
+        for (const auto& node : nodes) {
+            if (T* typed = dynamic_cast<T*>(node.get()))
+                found.push_back(typed);
+        }
+        return found;
+    }
+};
@@ -1,23 +1,809 @@
 #pragma once
 #include "nodes/Node.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+#include "OutputCache.h"
+#include "DiskCache.h"
+#include "GraphIO.h"
+#include "nodes/ImageInputNode.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 #include <unordered_set>
 #include <iostream>
 
 class GraphEngine {
 public:
-    void execute(Node* node, std::unordered_set<Node*>& visited) {
-        if (visited.find(node) != visited.end()) {
+    explicit GraphEngine(unsigned threadCount = std::thread::hardware_concurrency())
+        : pool(threadCount) {}
+
+    // Evaluate everything upstream of `node`, re-running only nodes whose
+    // parameters changed (or whose inputs were recomputed) since the last pass.
+    bool execute(Node* node, const CancellationToken* cancel = nullptr) {
+        return execute(std::vector<Node*>{ node }, cancel);
+    }
+
+    // Evaluate several sinks in one pass. Nodes are dispatched onto the thread
+    // pool as soon as all of their inputs are done, so sibling branches and
+    // independent sinks run concurrently. Shared upstream nodes run once.
+    //
+    // Once `cancel` is raised, nodes that have not started are skipped, tiled
+    // chains stop at the next tile, and nodes with long-running kernels stop
+    // at their next band of rows; the pass then returns false. Abandoned
+    // nodes are recomputed by the next pass.
+    bool execute(const std::vector<Node*>& sinks, const CancellationToken* cancel = nullptr) {
+        Pass pass;
+        pass.context.cancel = cancel;
+        pass.context.pool = &buffers;
+        pass.profiling = profilingEnabled.load();
+        pass.memoryCache = memo.enabled();
+        pass.memoize = pass.memoryCache || disk;
+        pass.start = Clock::now();
+        collect(sinks, pass);
+        if (pass.states.empty()) return true;
+
+        // The plan lists the sources up front: once tasks are running, other
+        // counters reach zero too and those nodes are scheduled by their inputs
+        pass.remaining = pass.states.size();
+        for (size_t i : pass.plan->sources)
+            schedule(pass, i);
+
+        {
+            std::unique_lock<std::mutex> lock(pass.doneMutex);
+            pass.done.wait(lock, [&pass] { return pass.remaining == 0; });
+        }
+
+        // Sizes this pass didn't ask for won't be asked for by the next one either
+        buffers.endPass();
+
+        // Record what was evaluated; only this thread touches the cache maps
+        for (NodeState& state : pass.states) {
+            if (state.deferred) {
+                evaluatedVersion.erase(state.node);
+                if (state.recomputed) deferredVersion[state.node] = state.version;
+                else if (state.failed) deferredVersion.erase(state.node);
+            } else {
+                deferredVersion.erase(state.node);
+                if (state.recomputed) evaluatedVersion[state.node] = state.version;
+                else if (state.failed) evaluatedVersion.erase(state.node);
+            }
+
+            if (state.released) releasedNodes.insert(state.node);
+            else if (state.materialized) releasedNodes.erase(state.node);
+        }
+
+        if (pass.profiling)
+            recordPass(pass);
+
+        if (pass.error)
+            std::rethrow_exception(pass.error);
+        return !pass.cancelled;
+    }
+
+    // Validate the graph upstream of `sinks` and compile it into a flat
+    // execution plan: nodes in topological order, each reading its inputs
+    // from precomputed slots. execute() does this itself on first use and
+    // reuses the plan for as long as the sinks and every node's inputs stay
+    // the same, so repeated passes skip the graph walk; calling it ahead of
+    // time just moves the cost (and the errors) up front. Throws, before
+    // any node runs, on cycles, on unconnected (null) inputs and on inputs
+    // wired to a port their source doesn't have. Call between passes.
+    void compile(const std::vector<Node*>& sinks) { compiled(sinks); }
+
+    // Forget all cached results and compiled plans so the next pass
+    // recomputes every node. Call after deleting nodes.
+    void invalidateAll() {
+        plans.clear();
+        evaluatedVersion.clear();
+        deferredVersion.clear();
+        releasedNodes.clear();
+        sourceKeys.clear();
+    }
+
+    // Tiled mode: chains of tileable nodes (each feeding only the next) are run
+    // tile by tile, so their intermediates never exist at full resolution.
+    // Each tile is padded by the sum of the chain's halo radii. 0 disables it.
+    void setTileSize(int pixels) {
+        if (pixels == tileSize) return;
+        tileSize = pixels > 0 ? pixels : 0;
+        invalidateAll();
+    }
+
+    int getTileSize() const { return tileSize; }
+
+    // Fusion: on 8-bit images, chains of point-wise nodes (brightness/contrast,
+    // binary threshold) run as one composed lookup table instead of one full
+    // pass and intermediate image per node. Results are identical either way.
+    void setFusion(bool enabled) {
+        if (enabled == fusion) return;
+        fusion = enabled;
+        invalidateAll();
+    }
+
+    bool getFusion() const { return fusion; }
+
+    // Memory planning: release each intermediate output (back to the buffer
+    // pool) as soon as the last node reading it this pass is done, so peak
+    // memory follows the live set instead of the whole graph. Sinks and pinned
+    // nodes keep their results. A released node is still considered up to
+    // date; it is recomputed only when a consumer that has to run needs it.
+    // The last reader of a released output receives the only reference to it,
+    // which lets nodes that support it work in place.
+    //
+    // Off by default: an interactive session changing one parameter at a time
+    // would otherwise recompute from the sources on every edit.
+    void setReleaseIntermediates(bool enabled) { releaseIntermediates = enabled; }
+    bool getReleaseIntermediates() const { return releaseIntermediates; }
+
+    // Keep a node's output across passes even when intermediates are released,
+    // e.g. because the UI previews it. Call between passes.
+    void pin(Node* node) { pinned.insert(node); }
+    void unpin(Node* node) { pinned.erase(node); }
+    bool isPinned(Node* node) const { return pinned.count(node) != 0; }
+
+    unsigned threadCount() const { return pool.size(); }
+
+    // Buffers node outputs and scratch images are recycled through
+    BufferPool& bufferPool() { return buffers; }
+
+    // Most bytes of free buffers the pool keeps between passes (1 GiB by
+    // default). Every engine has its own pool, so processes running many
+    // engines should split their total between them.
+    void setBufferBudget(size_t bytes) { buffers.setBudget(bytes); }
+
+    // Memoization: results are also kept by content, keyed on node type,
+    // parameters and the keys of the inputs (sources hash their pixels), so
+    // returning to an earlier configuration restores what was computed then
+    // instead of recomputing it. Budget in bytes; 0, the default, turns it off.
+    void setCacheBudget(size_t bytes) {
+        memo.setBudget(bytes);
+        if (bytes == 0) memo.clear();
+    }
+
+    // Hit and miss counters, current size
+    OutputCache& outputCache() { return memo; }
+
+    // Disk cache: results that took at least `minComputeMs` to compute are
+    // also written to `directory` (see DiskCache) under the same keys, and
+    // later sessions or restarted batch jobs map them back in instead of
+    // recomputing. Cheap nodes are left out; reading them back would cost
+    // more than running them. Results are written on the cache's own
+    // thread, so passes don't wait for the disk. Call between passes.
+    // Returns false if the directory can't be used.
+    bool setDiskCache(const std::string& directory, size_t budgetBytes = 0, double minComputeMs = 20) {
+        return setDiskCache(std::make_shared<DiskCache>(directory, budgetBytes), minComputeMs);
+    }
+
+    // Same, with a cache shared between engines (e.g. a batch job's workers),
+    // so its byte budget holds for all of them together
+    bool setDiskCache(std::shared_ptr<DiskCache> cache, double minComputeMs = 20) {
+        disk = cache && cache->isOpen() ? std::move(cache) : nullptr;
+        diskMinComputeMs = minComputeMs;
+        return disk != nullptr;
+    }
+
+    void disableDiskCache() { disk.reset(); }
+
+    // nullptr when off
+    DiskCache* diskCache() { return disk.get(); }
+
+    // Profiling: every pass records wall and CPU time, output size and cv::Mat
+    // allocation bytes for each node it runs. Allocations are only counted
+    // once profiling::installAllocationCounter() has run at startup. Off by
+    // default; costs a few clock reads per node when on. Safe to toggle from
+    // any thread.
+    void setProfiling(bool enabled) { profilingEnabled = enabled; }
+
+    bool getProfiling() const { return profilingEnabled; }
+
+    // The most recent profiled passes (up to MAX_PROFILED_PASSES), oldest first.
+    // Safe to call while a pass is running.
+    std::vector<PassProfile> profileHistory() const {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        return std::vector<PassProfile>(profiles.begin(), profiles.end());
+    }
+
+    PassProfile lastProfile() const {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        return profiles.empty() ? PassProfile() : profiles.back();
+    }
+
+    void clearProfiles() {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        profiles.clear();
+    }
+
+    static const size_t MAX_PROFILED_PASSES = 120;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // One node of a compiled graph. Its slot is its position in the plan's
+    // program, which is also where its state lives during a pass, so inputs
+    // and consumers are found by index instead of by hashing nodes.
+    struct Instruction {
+        Node* node = nullptr;
+        std::vector<size_t> inputs;        // Slot of each input, same order as node->inputs
+        std::vector<size_t> consumers;     // One entry per edge into a consumer
+        bool sink = false;
+        std::vector<Node*> wiring;         // node->inputs and inputPorts when compiled,
+        std::vector<int> ports;            // to notice edits
+    };
+
+    // The graph upstream of some sinks in topological order (inputs first)
+    struct Plan {
+        std::vector<Node*> sinks;
+        std::vector<Instruction> program;
+        std::vector<size_t> sources;       // Slots without inputs
+
+        // Still describes the graph: same sinks and the same edges everywhere.
+        // Nodes that became reachable could only have done so through an edge
+        // that changed, so checking the compiled nodes is enough. Consumers
+        // are checked before their inputs, so a node that was disconnected
+        // and deleted is never looked at.
+        bool matches(const std::vector<Node*>& sinks) const {
+            if (sinks != this->sinks) return false;
+            for (auto op = program.rbegin(); op != program.rend(); ++op) {
+                if (op->node->inputs != op->wiring || op->node->inputPorts != op->ports) return false;
+            }
+            return true;
+        }
+    };
+
+    static const size_t MAX_PLANS = 4;
+    static inline const std::vector<size_t> NO_READS;
+
+    struct NodeState {
+        const Instruction* op = nullptr;   // Where the node sits in the plan
+        Node* node = nullptr;
+        std::atomic<int> pendingInputs{0}; // In-degree not yet satisfied this pass
+        CacheKey key;                      // Memo cache identity of the result, if `keyed`
+        bool keyed = false;
+        const std::vector<size_t>* reads = nullptr; // States whose outputs this node's process() reads
+        std::atomic<int> pendingReaders{0};// Readers of this output still to finish this pass
+        unsigned long long version = 0;
+        bool sink = false;
+        bool deferred = false;             // Computed as part of a downstream tiled chain
+        bool releasable = false;           // Output may be dropped once its readers are done
+        bool rematerialize = false;        // Up to date but released, and needed this pass
+        bool recomputed = false;
+        bool materialized = false;         // Holds a freshly computed output
+        bool released = false;
+        bool failed = false;
+        bool profiled = false;
+        NodeProfile profile;
+    };
+
+    struct Pass {
+        const Plan* plan = nullptr;
+        std::vector<NodeState> states;     // One per instruction of the plan, same order
+        std::mutex doneMutex;
+        std::condition_variable done;
+        size_t remaining = 0;              // Guarded by doneMutex
+        std::exception_ptr error;          // First exception thrown by a node
+        EvalContext context;               // Handed to every node this pass runs
+        std::atomic<bool> cancelled{false};
+        bool profiling = false;
+        bool memoize = false;              // Keys are computed; some cache is on
+        bool memoryCache = false;
+        Clock::time_point start;
+    };
+
+    ThreadPool pool;
+    BufferPool buffers;
+    int tileSize = 0;
+    bool fusion = true;
+    bool releaseIntermediates = false;
+    std::unordered_set<Node*> pinned;
+
+    // Recently compiled plans, most recently used first: an editor alternates
+    // between previewing one node and writing its outputs
+    std::list<Plan> plans;
+
+    // Up-to-date nodes whose output was released, with nothing cached
+    std::unordered_set<Node*> releasedNodes;
+
+    OutputCache memo;
+    std::shared_ptr<DiskCache> disk;
+    double diskMinComputeMs = 20;
+
+    // Pixel hash of each source image, by the version it was taken at
+    std::unordered_map<Node*, std::pair<unsigned long long, CacheKey>> sourceKeys;
+
+    // Version of each node at the time its cached output was produced
+    std::unordered_map<Node*, unsigned long long> evaluatedVersion;
+
+    // Same, for chain members whose output was consumed tile by tile and released
+    std::unordered_map<Node*, unsigned long long> deferredVersion;
+
+    std::atomic<bool> profilingEnabled{false};
+    mutable std::mutex profileMutex;
+    std::deque<PassProfile> profiles;      // Guarded by profileMutex
+    unsigned long long profiledPasses = 0;
+    Clock::time_point profileEpoch;        // Start of the first profiled pass
+
+    // Set up this pass's states from the compiled plan for `sinks`
+    void collect(const std::vector<Node*>& sinks, Pass& pass) {
+        pass.plan = &compiled(sinks);
+        const std::vector<Instruction>& program = pass.plan->program;
+
+        pass.states = std::vector<NodeState>(program.size());
+        for (size_t i = 0; i < program.size(); ++i) {
+            NodeState& state = pass.states[i];
+            state.op = &program[i];
+            state.node = program[i].node;
+            state.version = state.node->version;
+            state.sink = program[i].sink;
+            state.pendingInputs.store(static_cast<int>(program[i].inputs.size()), std::memory_order_relaxed);
+        }
+
+        // A node is folded into its consumer's chain when nothing else needs its
+        // full result and the pair can be tiled or fused together. Whether a
+        // node is tileable or point-wise depends on its parameters, so this is
+        // decided every pass rather than compiled in.
+        for (NodeState& state : pass.states) {
+            if (state.sink || state.op->consumers.size() != 1 || !isSingleInput(state)) continue;
+            const NodeState& consumer = pass.states[state.op->consumers[0]];
+            if (!isSingleInput(consumer)) continue;
+
+            bool tiled = tileSize > 0 && state.node->isTileable() && consumer.node->isTileable();
+            bool fused = fusion && state.node->isPointwise() && consumer.node->isPointwise();
+            state.deferred = tiled || fused;
+        }
+
+        planMemory(pass);
+        if (pass.memoize)
+            computeKeys(pass);
+    }
+
+    // The plan for `sinks`, compiled now unless a recent one still matches
+    const Plan& compiled(const std::vector<Node*>& sinks) {
+        for (auto it = plans.begin(); it != plans.end(); ++it) {
+            if (it->matches(sinks)) {
+                plans.splice(plans.begin(), plans, it);
+                return plans.front();
+            }
+        }
+        plans.push_front(compilePlan(sinks));
+        if (plans.size() > MAX_PLANS)
+            plans.pop_back();
+        return plans.front();
+    }
+
+    static Plan compilePlan(const std::vector<Node*>& sinks) {
+        // Everything reachable from the sinks, iteratively so deep graphs
+        // can't overflow the stack
+        std::unordered_map<Node*, size_t> index;
+        std::vector<Node*> found, stack;
+        for (Node* sink : sinks) {
+            if (sink) stack.push_back(sink);
+        }
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            if (!index.emplace(node, found.size()).second) continue;
+            found.push_back(node);
+            for (size_t k = 0; k < node->inputs.size(); ++k) {
+                if (!node->inputs[k])
+                    throw std::runtime_error("GraphEngine: input " + std::to_string(k) + " of " + node->name
+                                             + " is not connected");
+                stack.push_back(node->inputs[k]);
+            }
+        }
+
+        std::vector<std::vector<size_t>> consumers(found.size());
+        std::vector<int> inDegree(found.size());
+        for (size_t i = 0; i < found.size(); ++i) {
+            Node* node = found[i];
+            for (size_t k = 0; k < node->inputs.size(); ++k) {
+                Node* input = node->inputs[k];
+                int port = node->inputPort(k);
+                if (port < 0 || port >= input->outputCount())
+                    throw std::runtime_error("GraphEngine: " + node->name + " reads port " + std::to_string(port)
+                                             + " of " + input->name + ", which has "
+                                             + std::to_string(input->outputCount()) + " output(s)");
+                consumers[index[input]].push_back(i);
+                ++inDegree[i];
+            }
+        }
+
+        // Kahn's algorithm; a cycle would leave its nodes waiting on each other forever
+        std::vector<size_t> ready, slot(found.size());
+        std::vector<Node*> order;
+        for (size_t i = 0; i < found.size(); ++i) {
+            if (inDegree[i] == 0) ready.push_back(i);
+        }
+        while (!ready.empty()) {
+            size_t i = ready.back();
+            ready.pop_back();
+            slot[i] = order.size();
+            order.push_back(found[i]);
+            for (size_t consumer : consumers[i]) {
+                if (--inDegree[consumer] == 0) ready.push_back(consumer);
+            }
+        }
+        if (order.size() != found.size())
+            throw std::runtime_error("GraphEngine: node graph contains a cycle");
+
+        Plan plan;
+        plan.sinks = sinks;
+        plan.program.resize(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            Instruction& op = plan.program[i];
+            op.node = order[i];
+            op.wiring = op.node->inputs;
+            op.ports = op.node->inputPorts;
+            for (Node* input : op.node->inputs) {
+                size_t from = slot[index[input]];
+                op.inputs.push_back(from);
+                plan.program[from].consumers.push_back(i);
+            }
+            if (op.inputs.empty()) plan.sources.push_back(i);
+        }
+        for (Node* sink : sinks) {
+            if (sink) plan.program[slot[index[sink]]].sink = true;
+        }
+        return plan;
+    }
+
+    // Memo cache keys, Merkle style: only sources look at pixels, and only
+    // when their version changed
+    void computeKeys(Pass& pass) {
+        for (NodeState& state : pass.states) {
+            Node* node = state.node;
+            std::string parameters;
+            try {
+                parameters = describeNode(*node);
+            } catch (const std::runtime_error&) {
+                continue;  // Type the cache can't identify
+            }
+            state.key = CacheKey::of(parameters + " level=" + std::to_string(node->getPreviewLevel()));
+
+            if (state.op->inputs.empty()) {
+                auto* source = dynamic_cast<ImageInputNode*>(node);
+                if (!source) continue;
+                auto known = sourceKeys.find(node);
+                if (known == sourceKeys.end() || known->second.first != state.version)
+                    known = sourceKeys.insert_or_assign(node, std::make_pair(state.version, CacheKey::ofImage(source->getImage()))).first;
+                state.key.combine(known->second.second);
+                state.keyed = true;
+                continue;
+            }
+
+            bool inputsKeyed = true;
+            for (size_t k = 0; k < state.op->inputs.size(); ++k) {
+                const NodeState& input = pass.states[state.op->inputs[k]];
+                inputsKeyed &= input.keyed;
+                state.key.combine(input.key);
+                if (int port = node->inputPort(k))
+                    state.key.combine(CacheKey::of("port " + std::to_string(port)));
+            }
+            state.keyed = inputsKeyed;
+        }
+    }
+
+    // Work out, before anything runs, who reads each output and which released
+    // outputs have to be brought back because a consumer will recompute.
+    // States are in topological order.
+    void planMemory(Pass& pass) {
+        std::vector<NodeState>& states = pass.states;
+
+        // Which nodes will see a change, the same test run() makes as it goes
+        std::vector<char> stale(states.size()), runs(states.size());
+        for (size_t i = 0; i < states.size(); ++i) {
+            NodeState& state = states[i];
+            const auto& cache = state.deferred ? deferredVersion : evaluatedVersion;
+            auto it = cache.find(state.node);
+            bool changed = it == cache.end() || it->second != state.version;
+            for (size_t from : state.op->inputs) changed |= stale[from] != 0;
+            stale[i] = changed;
+        }
+
+        // Consumers come later in topological order, so walk it backwards
+        for (size_t i = states.size(); i-- > 0;) {
+            NodeState& state = states[i];
+            bool consumerRuns = false;
+            for (size_t consumer : state.op->consumers) consumerRuns |= runs[consumer] != 0;
+
+            if (state.deferred) {
+                runs[i] = consumerRuns;  // Evaluated as part of its consumer's chain
+            } else {
+                bool released = releasedNodes.count(state.node) != 0;
+                state.rematerialize = released && !stale[i] && (state.sink || consumerRuns);
+                runs[i] = stale[i] || state.rematerialize;
+            }
+        }
+
+        // A chain's tail reads the input of the chain's head; deferred nodes read nothing
+        for (NodeState& state : states) {
+            if (state.deferred) continue;
+            if (!state.op->inputs.empty() && states[state.op->inputs[0]].deferred) {
+                size_t head = state.op->inputs[0];
+                while (states[states[head].op->inputs[0]].deferred)
+                    head = states[head].op->inputs[0];
+                state.reads = &states[head].op->inputs;
+            } else {
+                state.reads = &state.op->inputs;
+            }
+            for (size_t from : *state.reads)
+                states[from].pendingReaders.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (NodeState& state : states) {
+            state.releasable = releaseIntermediates && !state.sink && !state.deferred
+                            && !state.op->consumers.empty() && !pinned.count(state.node);
+        }
+    }
+
+    static bool isSingleInput(const NodeState& state) {
+        return state.op->inputs.size() == 1;
+    }
+
+    void schedule(Pass& pass, size_t i) {
+        pool.submit([this, &pass, i] { run(pass, i); });
+    }
+
+    void run(Pass& pass, size_t i) {
+        NodeState& state = pass.states[i];
+
+        bool inputsChanged = false;
+        bool inputsFailed = false;
+        for (size_t from : state.op->inputs) {
+            inputsChanged |= pass.states[from].recomputed;
+            inputsFailed |= pass.states[from].failed;
+        }
+
+        if (inputsFailed) {
+            state.failed = true;
+        } else if (state.deferred) {
+            // Nothing to compute yet; just tell the chain's tail whether it is stale
+            auto it = deferredVersion.find(state.node);
+            state.recomputed = inputsChanged || it == deferredVersion.end() || it->second != state.version;
+        } else {
+            // Reuse the cached output if nothing this node depends on has changed.
+            // evaluatedVersion is only written after the pass, so reading it here is safe.
+            auto it = evaluatedVersion.find(state.node);
+            bool upToDate = !inputsChanged && it != evaluatedVersion.end() && it->second == state.version;
+            bool needed = !upToDate || state.rematerialize;
+
+            if (needed && pass.context.isCancelled()) {
+                // Skipped, not failed: no error, but nothing downstream may use it
+                state.failed = true;
+                pass.cancelled = true;
+            } else if (needed) {
+                std::vector<cv::Mat> inputImages;
+                inputImages.reserve(state.node->inputs.size());
+                for (size_t k = 0; k < state.node->inputs.size(); ++k)
+                    inputImages.push_back(state.node->inputs[k]->getOutput(state.node->inputPort(k)));
+                // As the last reader of a releasable input, take over its buffer
+                // so the producer no longer holds a reference to it. Chains read
+                // their source themselves, so they are left alone.
+                bool chainTail = !state.op->inputs.empty() && pass.states[state.op->inputs[0]].deferred;
+                for (size_t from : chainTail ? NO_READS : *state.reads) {
+                    NodeState& producer = pass.states[from];
+                    if (producer.releasable && producer.pendingReaders.load(std::memory_order_acquire) == 1) {
+                        producer.node->releaseOutput();
+                        producer.released = true;
+                    }
+                }
+
+                Clock::time_point started;
+                double cpuStart = 0;
+                size_t allocatedStart = 0;
+                if (pass.profiling) {
+                    started = Clock::now();
+                    cpuStart = profiling::threadCpuMs();
+                    allocatedStart = profiling::threadAllocatedBytes();
+                }
+
+                try {
+                    // Sources are cheap, and hashing them already happened
+                    bool memoized = pass.memoize && state.keyed && !state.op->inputs.empty()
+                                 && state.node->isMemoizable();
+                    cv::Mat cached;
+                    if (memoized && pass.memoryCache)
+                        cached = memo.find(state.key);
+                    if (memoized && cached.empty() && disk) {
+                        cached = disk->load(state.key);
+                        if (!cached.empty()) memo.insert(state.key, cached);
+                    }
+
+                    if (!cached.empty()) {
+                        state.node->output = cached;
+                    } else {
+                        // The cache may share the previous result; never write over it
+                        if (memoized) state.node->output.release();
+                        Clock::time_point computeStart = Clock::now();
+                        if (chainTail)
+                            processChain(pass, i);
+                        else
+                            state.node->process(inputImages, pass.context);
+                        if (memoized) {
+                            memo.insert(state.key, state.node->output);
+                            double computeMs = std::chrono::duration<double, std::milli>(Clock::now() - computeStart).count();
+                            if (disk && computeMs >= diskMinComputeMs)
+                                disk->storeAsync(state.key, state.node->output);
+                        }
+                    }
+                    state.recomputed = !upToDate;
+                    state.materialized = true;
+                } catch (const EvaluationCancelled&) {
+                    state.failed = true;
+                    pass.cancelled = true;
+                } catch (...) {
+                    state.failed = true;
+                    std::lock_guard<std::mutex> lock(pass.doneMutex);
+                    if (!pass.error) pass.error = std::current_exception();
+                }
+
+                if (pass.profiling) {
+                    NodeProfile& profile = state.profile;
+                    profile.node = state.node;
+                    profile.name = chainLabel(pass, i);
+                    profile.thread = std::this_thread::get_id();
+                    profile.startMs = std::chrono::duration<double, std::milli>(started - pass.start).count();
+                    profile.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+                    profile.cpuMs = profiling::threadCpuMs() - cpuStart;
+                    profile.outputBytes = state.node->output.total() * state.node->output.elemSize();
+                    profile.allocatedBytes = profiling::threadAllocatedBytes() - allocatedStart;
+                    state.profiled = true;
+                }
+            }
+        }
+
+        // Outputs nobody else reads this pass are dead now
+        for (size_t from : state.reads ? *state.reads : NO_READS) {
+            NodeState& producer = pass.states[from];
+            if (producer.pendingReaders.fetch_sub(1, std::memory_order_acq_rel) == 1 && producer.releasable) {
+                producer.node->releaseOutput();
+                producer.released = true;
+            }
+        }
+
+        // Release consumers whose inputs are now all available
+        for (size_t consumer : state.op->consumers) {
+            if (pass.states[consumer].pendingInputs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                schedule(pass, consumer);
+        }
+
+        std::lock_guard<std::mutex> lock(pass.doneMutex);
+        if (--pass.remaining == 0)
+            pass.done.notify_all();
+    }
+
+    // Names of the node and, if it ends a chain, the deferred nodes run with it
+    static std::string chainLabel(const Pass& pass, size_t tail) {
+        std::string label = pass.states[tail].node->name;
+        size_t i = tail;
+        while (!pass.states[i].op->inputs.empty() && pass.states[pass.states[i].op->inputs[0]].deferred) {
+            i = pass.states[i].op->inputs[0];
+            label = pass.states[i].node->name + " > " + label;
+        }
+        return label;
+    }
+
+    void recordPass(Pass& pass) {
+        if (profiledPasses == 0) profileEpoch = pass.start;
+
+        PassProfile profile;
+        profile.index = profiledPasses++;
+        profile.startMs = std::chrono::duration<double, std::milli>(pass.start - profileEpoch).count();
+        profile.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - pass.start).count();
+        for (NodeState& state : pass.states) {
+            if (state.profiled) profile.nodes.push_back(std::move(state.profile));
+        }
+        std::sort(profile.nodes.begin(), profile.nodes.end(),
+                  [](const NodeProfile& a, const NodeProfile& b) { return a.startMs < b.startMs; });
+
+        std::lock_guard<std::mutex> lock(profileMutex);
+        profiles.push_back(std::move(profile));
+        while (profiles.size() > MAX_PROFILED_PASSES)
+            profiles.pop_front();
+    }
+
+    // Run the chain of deferred nodes ending at `tail`, one tile at a time if
+    // every node allows it, and materialize only the tail's full-size output
+    void processChain(Pass& pass, size_t tail) {
+        std::vector<Node*> chain;
+        size_t head = tail;
+        chain.push_back(pass.states[tail].node);
+        while (pass.states[pass.states[head].op->inputs[0]].deferred) {
+            head = pass.states[head].op->inputs[0];
+            chain.push_back(pass.states[head].node);
+        }
+        std::reverse(chain.begin(), chain.end());
+
+        const EvalContext& context = pass.context;
+        cv::Mat source = chain.front()->inputs[0]->getOutput(chain.front()->inputPort(0));
+        if (source.empty()) {
+            // Let the head report the missing input the usual way
+            chain.front()->process(std::vector<cv::Mat>{ source }, context);
+            for (Node* node : chain) node->output.release();
             return;
         }
 
-        visited.insert(node);
+        bool tileable = tileSize > 0;
+        int halo = 0;
+        for (Node* node : chain) {
+            tileable &= node->isTileable();
+            halo += node->haloRadius();
+        }
 
-        // ✅ First process all inputs
-        for (Node* input : node->inputs) {
-            execute(input, visited);
+        if (!tileable) {
+            cv::Mat result = runChain(chain, source, context);
+            for (Node* node : chain) node->output.release();
+            chain.back()->output = result;
+            return;
         }
 
-        // ✅ THEN process this node
-        node->process();
+        cv::Mat result;
+        const cv::Rect bounds(0, 0, source.cols, source.rows);
+        for (int y = 0; y < source.rows; y += tileSize) {
+            for (int x = 0; x < source.cols; x += tileSize) {
+                cv::Rect core(x, y, std::min(tileSize, source.cols - x), std::min(tileSize, source.rows - y));
+                cv::Rect padded = cv::Rect(core.x - halo, core.y - halo, core.width + 2 * halo, core.height + 2 * halo) & bounds;
+                context.throwIfCancelled();
+
+                // The first node reads a view into the source, so it sees real
+                // neighbours; later nodes only need the halo to absorb their borders
+                cv::Mat tile = runChain(chain, source(padded), context);
+                if (tile.empty()) {
+                    result = cv::Mat();
+                    break;
+                }
+
+                if (result.empty())
+                    result = context.buffer(source.size(), tile.type());
+                tile(cv::Rect(core.x - padded.x, core.y - padded.y, core.width, core.height)).copyTo(result(core));
+            }
+            if (result.empty()) break;
+        }
+
+        for (Node* node : chain) node->output.release();
+        chain.back()->output = result;
+    }
+
+    // Push one image (or tile) through a chain. On 8-bit data, runs of two or
+    // more point-wise nodes are composed into a single lookup table and
+    // applied in one pass, so their intermediates are never written.
+    cv::Mat runChain(const std::vector<Node*>& chain, cv::Mat image, const EvalContext& context) const {
+        size_t i = 0;
+        while (i < chain.size() && !image.empty()) {
+            size_t end = i;
+            if (fusion && image.depth() == CV_8U) {
+                while (end < chain.size() && chain[end]->isPointwise()) ++end;
+            }
+
+            if (end - i >= 2) {
+                cv::Mat lut = chain[i]->pointwiseLut();
+                for (size_t k = i + 1; k < end; ++k) {
+                    cv::Mat composed;
+                    cv::LUT(lut, chain[k]->pointwiseLut(), composed);  // chain[k] after lut
+                    lut = composed;
+                }
+                cv::Mat fused = context.buffer(image.size(), image.type());
+                cv::LUT(image, lut, fused);
+                image = fused;
+                i = end;
+            } else {
+                // Hand each member the only reference to its predecessor's
+                // result, so point-wise members can work in place
+                std::vector<cv::Mat> input(1);
+                input[0] = std::move(image);
+                chain[i]->process(input, context);
+                image = chain[i]->output;
+                chain[i]->output.release();
+                ++i;
+            }
+        }
+        return image;
     }
 };
@@ -0,0 +1,281 @@
+#include "GraphIO.h"
+#include "nodes/ImageInputNode.h"
+#include "nodes/VideoInputNode.h"
+#include "nodes/BrightnessContrastNode.h"
+#include "nodes/OutputNode.h"
+#include "nodes/ColorChannelSplitterNode.h"
+#include "nodes/BlurNode.h"
+#include "nodes/ThresholdNode.h"
+#include "nodes/EdgeDetectionNode.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using Params = std::unordered_map<std::string, std::string>;
+
+[[noreturn]] void fail(int line, const std::string& message) {
+    throw std::runtime_error("graph line " + std::to_string(line) + ": " + message);
+}
+
+// Split on whitespace, keeping double-quoted runs (quotes removed) together
+std::vector<std::string> tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string current;
+    bool quoted = false, inToken = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            inToken = true;
+        } else if (!quoted && (c == ' ' || c == '\t' || c == '\r')) {
+            if (inToken) tokens.push_back(current);
+            current.clear();
+            inToken = false;
+        } else {
+            current += c;
+            inToken = true;
+        }
+    }
+    if (inToken) tokens.push_back(current);
+    return tokens;
+}
+
+std::string quote(const std::string& value) {
+    return value.find_first_of(" \t") == std::string::npos && !value.empty() ? value : "\"" + value + "\"";
+}
+
+std::string get(const Params& params, const char* key, const std::string& fallback) {
+    auto it = params.find(key);
+    return it == params.end() ? fallback : it->second;
+}
+
+double getNumber(const Params& params, const char* key, double fallback, int line) {
+    auto it = params.find(key);
+    if (it == params.end()) return fallback;
+    try {
+        size_t used = 0;
+        double value = std::stod(it->second, &used);
+        if (used == it->second.size()) return value;
+    } catch (const std::exception&) {
+    }
+    fail(line, std::string("'") + key + "' is not a number: " + it->second);
+}
+
+bool getBool(const Params& params, const char* key, bool fallback, int line) {
+    auto it = params.find(key);
+    if (it == params.end()) return fallback;
+    if (it->second == "1" || it->second == "true") return true;
+    if (it->second == "0" || it->second == "false") return false;
+    fail(line, std::string("'") + key + "' is not a boolean: " + it->second);
+}
+
+int thresholdMethodFromName(const std::string& name, int line) {
+    if (name == "binary") return ThresholdNode::BINARY;
+    if (name == "adaptive") return ThresholdNode::ADAPTIVE;
+    if (name == "otsu") return ThresholdNode::OTSU;
+    fail(line, "unknown threshold method: " + name);
+}
+
+const char* thresholdMethodName(int method) {
+    switch (method) {
+        case ThresholdNode::ADAPTIVE: return "adaptive";
+        case ThresholdNode::OTSU: return "otsu";
+        default: return "binary";
+    }
+}
+
+Node* createNode(Graph& graph, const std::string& type, const Params& p, const GraphLoadOptions& options, int line) {
+    if (type == "ImageInput") {
+        ImageInputNode* node = graph.add<ImageInputNode>();
+        std::string path = get(p, "path", "");
+        if (options.loadImages && !path.empty())
+            node->reload(path);
+        else
+            node->setImage(cv::Mat(), path);  // Remember where it would come from
+        return node;
+    }
+    if (type == "VideoInput") {
+        VideoInputNode* node = graph.add<VideoInputNode>();
+        std::string path = get(p, "path", "");
+        if (options.loadImages && !path.empty())
+            node->open(path);
+        else
+            node->setSource(path);
+        return node;
+    }
+    if (type == "BrightnessContrast") {
+        return graph.add<BrightnessContrastNode>(getNumber(p, "alpha", 1.0, line),
+                                                 static_cast<int>(getNumber(p, "beta", 0, line)));
+    }
+    if (type == "Blur") {
+        BlurNode* node = graph.add<BlurNode>();
+        node->setParameters(static_cast<int>(getNumber(p, "radius", 5, line)), getBool(p, "directional", false, line));
+        std::string mode = get(p, "mode", "gaussian");
+        if (mode != "gaussian" && mode != "box") fail(line, "unknown blur mode: " + mode);
+        node->setMode(mode == "box" ? BlurNode::BOX_APPROX : BlurNode::GAUSSIAN);
+        return node;
+    }
+    if (type == "Threshold") {
+        return graph.add<ThresholdNode>(getNumber(p, "value", 128, line),
+                                        thresholdMethodFromName(get(p, "method", "binary"), line));
+    }
+    if (type == "EdgeDetection") {
+        std::string method = get(p, "method", "canny");
+        if (method != "sobel" && method != "canny") fail(line, "unknown edge method: " + method);
+        return graph.add<EdgeDetectionNode>(method == "sobel" ? EdgeDetectionNode::SOBEL : EdgeDetectionNode::CANNY,
+                                            static_cast<int>(getNumber(p, "kernel", 3, line)),
+                                            getNumber(p, "t1", 100, line), getNumber(p, "t2", 200, line),
+                                            getBool(p, "overlay", false, line));
+    }
+    if (type == "ColorChannelSplitter") {
+        return graph.add<ColorChannelSplitterNode>(getBool(p, "grayscale", true, line));
+    }
+    if (type == "Output") {
+        return graph.add<OutputNode>(get(p, "file", "output"), get(p, "format", "jpg"),
+                                     static_cast<int>(getNumber(p, "quality", 95, line)));
+    }
+    fail(line, "unknown node type: " + type);
+}
+
+} // namespace
+
+// Type name and parameters of a node, in the format's order
+std::string describeNode(const Node& node) {
+    std::ostringstream out;
+    out.precision(12);
+    if (auto* n = dynamic_cast<const VideoInputNode*>(&node)) {
+        out << "VideoInput";
+        if (!n->getSource().empty()) out << " path=" << quote(n->getSource());
+    } else if (auto* n = dynamic_cast<const ImageInputNode*>(&node)) {
+        out << "ImageInput";
+        if (!n->getPath().empty()) out << " path=" << quote(n->getPath());
+    } else if (auto* n = dynamic_cast<const BrightnessContrastNode*>(&node)) {
+        out << "BrightnessContrast alpha=" << n->getAlpha() << " beta=" << n->getBeta();
+    } else if (auto* n = dynamic_cast<const BlurNode*>(&node)) {
+        out << "Blur radius=" << n->getRadius() << " directional=" << (n->isDirectional() ? 1 : 0)
+            << " mode=" << (n->getMode() == BlurNode::BOX_APPROX ? "box" : "gaussian");
+    } else if (auto* n = dynamic_cast<const ThresholdNode*>(&node)) {
+        out << "Threshold value=" << n->getThresholdValue() << " method=" << thresholdMethodName(n->getMethod());
+    } else if (auto* n = dynamic_cast<const EdgeDetectionNode*>(&node)) {
+        out << "EdgeDetection method=" << (n->getMethod() == EdgeDetectionNode::SOBEL ? "sobel" : "canny")
+            << " kernel=" << n->getKernelSize() << " t1=" << n->getThreshold1() << " t2=" << n->getThreshold2()
+            << " overlay=" << (n->getOverlayEdges() ? 1 : 0);
+    } else if (auto* n = dynamic_cast<const ColorChannelSplitterNode*>(&node)) {
+        out << "ColorChannelSplitter grayscale=" << (n->getGrayscaleOutput() ? 1 : 0);
+    } else if (auto* n = dynamic_cast<const OutputNode*>(&node)) {
+        out << "Output file=" << quote(n->getFilename()) << " format=" << n->getFormat()
+            << " quality=" << n->getQuality();
+    } else {
+        throw std::runtime_error("node '" + node.name + "' has no serializable type");
+    }
+    return out.str();
+}
+
+std::unique_ptr<Graph> loadGraph(std::istream& in, const GraphLoadOptions& options) {
+    auto graph = std::make_unique<Graph>();
+    std::unordered_map<std::string, Node*> byId;
+    std::unordered_set<Node*> consumed;
+    bool explicitSinks = false;
+
+    std::string text;
+    int line = 0;
+    while (std::getline(in, text)) {
+        ++line;
+        std::vector<std::string> tokens = tokenize(text);
+        if (tokens.empty() || tokens[0][0] == '#') continue;
+
+        const std::string& keyword = tokens[0];
+        if (keyword == "node") {
+            if (tokens.size() < 3) fail(line, "expected 'node <id> <Type> [key=value ...]'");
+            if (byId.count(tokens[1])) fail(line, "duplicate node id: " + tokens[1]);
+
+            Params params;
+            for (size_t i = 3; i < tokens.size(); ++i) {
+                size_t eq = tokens[i].find('=');
+                if (eq == std::string::npos || eq == 0) fail(line, "expected key=value, got: " + tokens[i]);
+                params[tokens[i].substr(0, eq)] = tokens[i].substr(eq + 1);
+            }
+            byId[tokens[1]] = createNode(*graph, tokens[2], params, options, line);
+        } else if (keyword == "edge" || keyword == "sink") {
+            bool valid = keyword == "edge" ? tokens.size() == 3 || tokens.size() == 4 : tokens.size() == 2;
+            if (!valid) fail(line, "wrong number of arguments to '" + keyword + "'");
+
+            std::vector<Node*> ends;
+            for (size_t i = 1; i < std::min<size_t>(tokens.size(), 3); ++i) {
+                auto it = byId.find(tokens[i]);
+                if (it == byId.end()) fail(line, "unknown node id: " + tokens[i]);
+                ends.push_back(it->second);
+            }
+
+            if (keyword == "edge") {
+                int port = 0;
+                if (tokens.size() == 4) {
+                    Params portParam{ { "port", tokens[3] } };
+                    double value = getNumber(portParam, "port", 0, line);
+                    port = static_cast<int>(value);
+                    if (port != value || port < 0 || port >= ends[0]->outputCount())
+                        fail(line, "node " + tokens[1] + " has no output port " + tokens[3]);
+                }
+                ends[1]->connect(ends[0], port);
+                consumed.insert(ends[0]);
+            } else {
+                graph->sinks.push_back(ends[0]);
+                explicitSinks = true;
+            }
+        } else {
+            fail(line, "unknown statement: " + keyword);
+        }
+    }
+
+    if (!explicitSinks) {
+        for (const auto& node : graph->nodes) {
+            if (!consumed.count(node.get())) graph->sinks.push_back(node.get());
+        }
+    }
+    return graph;
+}
+
+std::unique_ptr<Graph> loadGraphFile(const std::string& path, const GraphLoadOptions& options) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open graph file: " + path);
+    return loadGraph(in, options);
+}
+
+void saveGraph(const Graph& graph, std::ostream& out) {
+    std::unordered_map<const Node*, size_t> ids;
+    for (size_t i = 0; i < graph.nodes.size(); ++i)
+        ids[graph.nodes[i].get()] = i;
+
+    out << "# node graph\n";
+    for (size_t i = 0; i < graph.nodes.size(); ++i)
+        out << "node " << i << " " << describeNode(*graph.nodes[i]) << "\n";
+
+    for (size_t i = 0; i < graph.nodes.size(); ++i) {
+        const Node& node = *graph.nodes[i];
+        for (size_t k = 0; k < node.inputs.size(); ++k) {
+            auto it = ids.find(node.inputs[k]);
+            if (it == ids.end())
+                throw std::runtime_error("saveGraph: node '" + node.name + "' has an input outside the graph");
+            out << "edge " << it->second << " " << i;
+            if (node.inputPort(k) != 0) out << " " << node.inputPort(k);
+            out << "\n";
+        }
+    }
+
+    for (Node* sink : graph.sinks) {
+        auto it = ids.find(sink);
+        if (it != ids.end()) out << "sink " << it->second << "\n";
+    }
+}
+
+bool saveGraphFile(const Graph& graph, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    saveGraph(graph, out);
+    return static_cast<bool>(out);
+}
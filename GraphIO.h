@@ -0,0 +1,42 @@
+#pragma once
+#include "Graph.h"
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+// Plain-text pipeline description, one statement per line:
+//
+//   # comment
+//   node <id> <Type> [key=value ...]
+//   edge <from id> <to id> [port] (appended to the target's inputs, in order;
+//                                  reads output port `port` of the source, default 0)
+//   sink <id>                     (nodes to evaluate; default: nodes without consumers)
+//
+// Types and keys:
+//   ImageInput            path
+//   VideoInput            path                  (video file or image sequence pattern)
+//   BrightnessContrast    alpha beta
+//   Blur                  radius directional mode(gaussian|box)
+//   Threshold             value method(binary|adaptive|otsu)
+//   EdgeDetection         method(sobel|canny) kernel t1 t2 overlay
+//   ColorChannelSplitter  grayscale
+//   Output                file format quality
+//
+// Values containing spaces are written in double quotes. Malformed input
+// throws std::runtime_error naming the offending line.
+
+struct GraphLoadOptions {
+    // Read ImageInput paths from disk while loading. Batch drivers that feed
+    // their own images turn this off to skip the decode.
+    bool loadImages = true;
+};
+
+std::unique_ptr<Graph> loadGraph(std::istream& in, const GraphLoadOptions& options = GraphLoadOptions());
+std::unique_ptr<Graph> loadGraphFile(const std::string& path, const GraphLoadOptions& options = GraphLoadOptions());
+
+void saveGraph(const Graph& graph, std::ostream& out);
+
+// A node's type and parameters as written by saveGraph ("Blur radius=5 ..."),
+// without its connections. Throws std::runtime_error for unknown node types.
+std::string describeNode(const Node& node);
+bool saveGraphFile(const Graph& graph, const std::string& path);
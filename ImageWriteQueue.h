@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Background encode/write stage for OutputNode. Encoding a large JPEG or PNG
+// takes longer than most nodes, so sinks hand their image over and return;
+// worker threads compress and write while the graph moves on to the next
+// frame. The queue is bounded: producers block once `capacity` images are
+// waiting, which keeps memory flat when the disk can't keep up.
+class ImageWriteQueue {
+public:
+    explicit ImageWriteQueue(unsigned threadCount = defaultThreadCount(), size_t maxQueued = 0)
+        : capacity(maxQueued > 0 ? maxQueued : 2 * std::max(1u, threadCount)) {
+        if (threadCount == 0) threadCount = 1;
+        for (unsigned i = 0; i < threadCount; ++i)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    // Writes everything still queued before returning
+    ~ImageWriteQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        notEmpty.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    ImageWriteQueue(const ImageWriteQueue&) = delete;
+    ImageWriteQueue& operator=(const ImageWriteQueue&) = delete;
+
+    // Process-wide queue the output nodes write through
+    static ImageWriteQueue& shared() {
+        static ImageWriteQueue queue;
+        return queue;
+    }
+
+    // Queue `image` for cv::imwrite. The queue keeps a reference, so callers
+    // must not write into the image's buffer afterwards.
+    void push(const std::string& path, const cv::Mat& image, const std::vector<int>& params) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [this] { return jobs.size() < capacity; });
+            jobs.push_back(Job{ path, image, params });
+        }
+        notEmpty.notify_one();
+    }
+
+    // Block until every write queued so far is on disk. Returns the number of
+    // writes that failed since the previous flush.
+    size_t flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return jobs.empty() && active == 0; });
+        size_t failed = failures;
+        failures = 0;
+        return failed;
+    }
+
+private:
+    struct Job {
+        std::string path;
+        cv::Mat image;
+        std::vector<int> params;
+    };
+
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull, idle;
+    std::deque<Job> jobs;
+    const size_t capacity;
+    size_t active = 0;      // Jobs being encoded right now
+    size_t failures = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    static unsigned defaultThreadCount() {
+        return std::max(2u, std::thread::hardware_concurrency() / 2);
+    }
+
+    void workerLoop() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                notEmpty.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                ++active;
+            }
+            notFull.notify_one();
+
+            bool success = false;
+            try {
+                success = cv::imwrite(job.path, job.image, job.params);
+            } catch (const cv::Exception& e) {
+                std::cerr << "[✘] " << e.what() << std::endl;
+            }
+
+            // Logging under the lock keeps lines from different workers whole
+            std::lock_guard<std::mutex> lock(mutex);
+            if (success) {
+                std::cout << "[✔] Image saved to: " << job.path << std::endl;
+            } else {
+                std::cerr << "[✘] Failed to save image: " << job.path << std::endl;
+                ++failures;
+            }
+            if (--active == 0 && jobs.empty())
+                idle.notify_all();
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include "GraphEngine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs all graph work for the editor on one background thread, so the UI
+// never blocks in GraphEngine::execute.
+//
+// The UI does not touch nodes directly while a LiveEvaluator owns them:
+// parameter changes, saves and explicit evaluations are posted as commands
+// and run on the evaluation thread in the order they were posted. With a
+// live target set, every command also schedules a re-evaluation of that
+// target. It is debounced until the commands pause for `quiet`, but never
+// put off longer than `maxDelay`. A pass still running when new commands
+// arrive is stale, so it is cancelled.
+class LiveEvaluator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LiveEvaluator(GraphEngine& graphEngine,
+                           std::chrono::milliseconds quietPeriod = std::chrono::milliseconds(30),
+                           std::chrono::milliseconds maxDelayPeriod = std::chrono::milliseconds(200))
+        : engine(graphEngine), quiet(quietPeriod), maxDelay(maxDelayPeriod) {
+        worker = std::thread([this] { workerLoop(); });
+    }
+
+    ~LiveEvaluator() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            cancel.cancel();
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    LiveEvaluator(const LiveEvaluator&) = delete;
+    LiveEvaluator& operator=(const LiveEvaluator&) = delete;
+
+    // Run `command` on the evaluation thread after everything posted before it
+    void post(std::function<void()> command) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            commands.push_back(std::move(command));
+            markStale();
+        }
+        wake.notify_all();
+    }
+
+    // Node to keep evaluated after every change, or nullptr to stop live updates
+    void setTarget(Node* node) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (node == target) return;
+            target = node;
+            markStale();
+        }
+        wake.notify_all();
+    }
+
+    // Make a node's current output available to fetch(). Only call this from
+    // the evaluation thread, i.e. from within a posted command.
+    void publish(Node* source) {
+        // Nodes may overwrite their buffers in place on the next pass, so the
+        // UI gets a copy it can read while evaluation goes on
+        cv::Mat image = source->getOutput().clone();
+        std::lock_guard<std::mutex> lock(mutex);
+        result = image;
+        resultSource = source;
+        ++resultSequence;
+    }
+
+    // The most recently published output, if it is newer than `sequence`
+    bool fetch(cv::Mat& image, Node*& source, unsigned long long& sequence) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (resultSequence == sequence) return false;
+        image = result;
+        source = resultSource;
+        sequence = resultSequence;
+        return true;
+    }
+
+    // True while work is queued, waiting out the debounce, or running
+    bool busy() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return running || !commands.empty() || (stale && target);
+    }
+
+private:
+    GraphEngine& engine;
+    const std::chrono::milliseconds quiet, maxDelay;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> commands;
+    Node* target = nullptr;
+    bool stale = false;                   // Target needs a pass
+    Clock::time_point firstChange, lastChange;
+    bool running = false;
+    bool stopping = false;
+    CancellationToken cancel;             // Raised once the running pass is stale
+
+    cv::Mat result;
+    Node* resultSource = nullptr;
+    unsigned long long resultSequence = 0;
+
+    std::thread worker;
+
+    // Caller holds the mutex
+    void markStale() {
+        Clock::time_point now = Clock::now();
+        if (!stale) firstChange = now;
+        lastChange = now;
+        stale = true;
+        cancel.cancel();
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !commands.empty() || (stale && target); });
+            if (stopping) return;
+
+            if (!commands.empty()) {
+                std::deque<std::function<void()>> batch;
+                batch.swap(commands);
+                cancel.reset();
+                running = true;
+                lock.unlock();
+                for (auto& command : batch) {
+                    try {
+                        command();
+                    } catch (const std::exception& e) {
+                        std::cerr << "[✘] " << e.what() << std::endl;
+                    }
+                }
+                lock.lock();
+                running = false;
+                continue;
+            }
+
+            Clock::time_point due = std::min(lastChange + quiet, firstChange + maxDelay);
+            if (Clock::now() < due) {
+                wake.wait_until(lock, due);
+                continue;
+            }
+
+            Node* node = target;
+            stale = false;
+            cancel.reset();
+            running = true;
+            lock.unlock();
+            try {
+                if (engine.execute(node, &cancel))
+                    publish(node);
+            } catch (const std::exception& e) {
+                std::cerr << "[✘] " << e.what() << std::endl;
+            }
+            lock.lock();
+            running = false;
+        }
+    }
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+
+// 128-bit identity of a node result: what computed it (node type and
+// parameters) and, recursively, what it was computed from. Source images
+// contribute a hash of their pixels, every other node the keys of its
+// inputs, so equal keys mean equal results without hashing intermediates.
+struct CacheKey {
+    uint64_t high = 0, low = 0;
+
+    bool operator==(const CacheKey& other) const { return high == other.high && low == other.low; }
+
+    struct Hash {
+        size_t operator()(const CacheKey& key) const { return static_cast<size_t>(key.low ^ (key.high >> 1)); }
+    };
+
+    static CacheKey of(const std::string& text) {
+        CacheKey key;
+        key.mix(text.data(), text.size());
+        return key;
+    }
+
+    // Pixels plus shape and type; walks row by row, so views work too
+    static CacheKey ofImage(const cv::Mat& image) {
+        CacheKey key;
+        int header[3] = { image.rows, image.cols, image.type() };
+        key.mix(header, sizeof(header));
+        const size_t rowBytes = image.cols * image.elemSize();
+        for (int y = 0; y < image.rows; ++y)
+            key.mix(image.ptr(y), rowBytes);
+        return key;
+    }
+
+    void combine(const CacheKey& other) {
+        uint64_t words[2] = { other.high, other.low };
+        mix(words, sizeof(words));
+    }
+
+    // Two independent 64-bit multiply-xor lanes over 8-byte words
+    void mix(const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        uint64_t a = high ^ 0x9e3779b97f4a7c15ull, b = low ^ 0xc2b2ae3d27d4eb4full;
+        for (; bytes >= 8; bytes -= 8, p += 8) {
+            uint64_t word;
+            std::memcpy(&word, p, 8);
+            a = (a ^ word) * 0x100000001b3ull;
+            a ^= a >> 29;
+            b = (b + word) * 0xff51afd7ed558ccdull;
+            b ^= b >> 32;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, p, bytes);  // Remaining 0..7 bytes, length in the unused top byte
+        tail ^= static_cast<uint64_t>(bytes) << 56;
+        a = (a ^ tail) * 0x100000001b3ull;
+        b = (b + tail) * 0xff51afd7ed558ccdull;
+        high = a ^ (b >> 31);
+        low = b ^ (a >> 27);
+    }
+};
+
+// Content-addressed results kept across parameter changes, so revisiting a
+// configuration (threshold binary -> otsu -> binary) is a lookup instead of
+// a recompute. Least recently used entries are dropped past the byte
+// budget; a budget of 0 disables the cache. Thread-safe.
+class OutputCache {
+public:
+    explicit OutputCache(size_t budgetBytes = 0) : budget(budgetBytes) {}
+
+    OutputCache(const OutputCache&) = delete;
+    OutputCache& operator=(const OutputCache&) = delete;
+
+    bool enabled() const { std::lock_guard<std::mutex> lock(mutex); return budget > 0; }
+
+    // Empty Mat on a miss. Cached images are shared: callers must not write into them.
+    cv::Mat find(const CacheKey& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            ++missCount;
+            return cv::Mat();
+        }
+        ++hitCount;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->image;
+    }
+
+    void insert(const CacheKey& key, const cv::Mat& image) {
+        size_t size = image.total() * image.elemSize();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (image.empty() || size > budget) return;
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            bytes -= it->second->bytes;
+            entries.erase(it->second);
+        }
+        entries.push_front(Entry{ key, image, size });
+        index[key] = entries.begin();
+        bytes += size;
+        trim();
+    }
+
+    void setBudget(size_t budgetBytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = budgetBytes;
+        trim();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        index.clear();
+        bytes = 0;
+    }
+
+    void resetCounters() {
+        std::lock_guard<std::mutex> lock(mutex);
+        hitCount = missCount = 0;
+    }
+
+    size_t budgetBytes() const { std::lock_guard<std::mutex> lock(mutex); return budget; }
+    size_t cachedBytes() const { std::lock_guard<std::mutex> lock(mutex); return bytes; }
+    size_t size() const { std::lock_guard<std::mutex> lock(mutex); return entries.size(); }
+    size_t hits() const { std::lock_guard<std::mutex> lock(mutex); return hitCount; }
+    size_t misses() const { std::lock_guard<std::mutex> lock(mutex); return missCount; }
+
+private:
+    struct Entry {
+        CacheKey key;
+        cv::Mat image;
+        size_t bytes;
+    };
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;      // Most recently used first
+    std::unordered_map<CacheKey, std::list<Entry>::iterator, CacheKey::Hash> index;
+    size_t budget;
+    size_t bytes = 0;
+    size_t hitCount = 0, missCount = 0;
+
+    // Caller holds the mutex
+    void trim() {
+        while (bytes > budget && !entries.empty()) {
+            bytes -= entries.back().bytes;
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+};
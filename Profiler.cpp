@@ -0,0 +1,126 @@
+#include "Profiler.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <opencv2/core.hpp>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+thread_local size_t allocatedOnThread = 0;
+
+// Forwards to OpenCV's standard allocator and counts the bytes of every new
+// buffer. Buffers keep the standard allocator as their owner, so releases
+// never come through here.
+class CountingAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        cv::UMatData* u = inner->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u && !data) allocatedOnThread += u->size;  // `data` set means a user buffer, not an allocation
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        return inner->allocate(u, flags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        inner->deallocate(u);
+    }
+
+private:
+    cv::MatAllocator* inner = cv::Mat::getStdAllocator();
+};
+
+std::string escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+namespace profiling {
+
+double threadCpuMs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) / 1e4;  // 100 ns units
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+#endif
+}
+
+void installAllocationCounter() {
+    static std::once_flag installed;
+    std::call_once(installed, [] {
+        static CountingAllocator allocator;
+        cv::Mat::setDefaultAllocator(&allocator);
+    });
+}
+
+size_t threadAllocatedBytes() {
+    return allocatedOnThread;
+}
+
+void writeChromeTrace(const std::vector<PassProfile>& passes, std::ostream& out) {
+    // Trace viewers want small integer thread ids
+    std::map<std::thread::id, int> threadIds;
+
+    // Times are microseconds; the default six significant digits would round
+    // a long session's timestamps to milliseconds and print short nodes in
+    // e-notation
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const PassProfile& pass : passes) {
+        out << (first ? "" : ",") << "\n"
+            << "{\"name\":\"pass " << pass.index << "\",\"cat\":\"pass\",\"ph\":\"X\",\"pid\":1,\"tid\":0"
+            << ",\"ts\":" << pass.startMs * 1e3 << ",\"dur\":" << pass.wallMs * 1e3 << "}";
+        first = false;
+
+        for (const NodeProfile& node : pass.nodes) {
+            auto it = threadIds.emplace(node.thread, static_cast<int>(threadIds.size()) + 1).first;
+            out << ",\n{\"name\":\"" << escape(node.name) << "\",\"cat\":\"node\",\"ph\":\"X\",\"pid\":1"
+                << ",\"tid\":" << it->second
+                << ",\"ts\":" << (pass.startMs + node.startMs) * 1e3 << ",\"dur\":" << node.wallMs * 1e3
+                << ",\"args\":{\"cpu_ms\":" << node.cpuMs << ",\"output_bytes\":" << node.outputBytes
+                << ",\"allocated_bytes\":" << node.allocatedBytes << "}}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool writeChromeTraceFile(const std::vector<PassProfile>& passes, const std::string& path) {
+    std::ofstream out(path);
+    if (!out) return false;
+    writeChromeTrace(passes, out);
+    return static_cast<bool>(out);
+}
+
+} // namespace profiling
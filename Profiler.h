@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Node;
+
+// What one node cost in one evaluation pass
+struct NodeProfile {
+    const Node* node = nullptr;
+    std::string name;           // Chains that ran as one unit are joined with " > "
+    std::thread::id thread;
+    double startMs = 0;         // Relative to the start of the pass
+    double wallMs = 0;
+    double cpuMs = 0;           // Calling thread only; OpenCV's own worker threads are not included
+    size_t outputBytes = 0;     // Size of the node's output buffer
+    size_t allocatedBytes = 0;  // cv::Mat memory allocated on the calling thread while it ran
+};
+
+// One GraphEngine::execute call. Nodes served from the cache don't appear.
+struct PassProfile {
+    unsigned long long index = 0;
+    double startMs = 0;         // Relative to the first profiled pass
+    double wallMs = 0;
+    std::vector<NodeProfile> nodes;  // In start order
+};
+
+namespace profiling {
+
+// CPU time consumed by the calling thread, in milliseconds
+double threadCpuMs();
+
+// Route cv::Mat allocations through a counting allocator. Idempotent; the
+// allocator stays installed for the rest of the process. Call at startup,
+// before other threads allocate Mats: OpenCV's default allocator is not
+// swapped atomically.
+void installAllocationCounter();
+
+// Bytes allocated through cv::Mat on the calling thread since the counter
+// was installed
+size_t threadAllocatedBytes();
+
+// Chrome trace event JSON (load in chrome://tracing or ui.perfetto.dev)
+void writeChromeTrace(const std::vector<PassProfile>& passes, std::ostream& out);
+bool writeChromeTraceFile(const std::vector<PassProfile>& passes, const std::string& path);
+
+} // namespace profiling
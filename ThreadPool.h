@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool used by GraphEngine to run independent nodes
+// concurrently. Every worker owns a deque: tasks submitted from a worker go
+// to the back of its own deque and are popped LIFO (the producer's outputs
+// are still hot in its cache); idle workers steal from the front of the
+// other deques. Tasks submitted from outside the pool are spread round-robin.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency()) {
+        if (threadCount == 0) threadCount = 1;
+
+        for (unsigned i = 0; i < threadCount; ++i)
+            queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < threadCount; ++i)
+            workers.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    void submit(std::function<void()> task) {
+        unsigned target = (currentPool == this)
+            ? currentWorker
+            : nextQueue.fetch_add(1, std::memory_order_relaxed) % size();
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            ++pending;
+        }
+        wake.notify_one();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    long pending = 0;        // Queued but not yet dequeued tasks (guarded by wakeMutex)
+    bool stopping = false;
+    std::atomic<unsigned> nextQueue{0};
+
+    // Identifies the pool/worker the calling thread belongs to, if any
+    static inline thread_local ThreadPool* currentPool = nullptr;
+    static inline thread_local unsigned currentWorker = 0;
+
+    bool popLocal(unsigned index, std::function<void()>& task) {
+        Queue& q = *queues[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned thief, std::function<void()>& task) {
+        for (unsigned offset = 1; offset < size(); ++offset) {
+            Queue& q = *queues[(thief + offset) % size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) continue;
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned index) {
+        currentPool = this;
+        currentWorker = index;
+
+        for (;;) {
+            std::function<void()> task;
+            if (popLocal(index, task) || steal(index, task)) {
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    --pending;
+                }
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [this] { return stopping || pending > 0; });
+            if (stopping && pending == 0) return;
+        }
+    }
+};
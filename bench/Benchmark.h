@@ -0,0 +1,117 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal Google-Benchmark-style harness with no external dependency.
+// A benchmark body loops with
+//
+//     for (auto _ : state) { ...work... }
+//
+// and the loop keeps running until it has taken at least the minimum time.
+class BenchState {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit BenchState(double minSeconds) : minSeconds(minSeconds) {}
+
+    // Loop variable type; the user-provided destructor keeps compilers from
+    // flagging the deliberately unused `_`
+    struct Value {
+        ~Value() {}
+    };
+
+    struct Iterator {
+        BenchState* state;
+        bool operator!=(const Iterator&) const { return state->keepRunning(); }
+        void operator++() {}
+        Value operator*() const { return Value(); }
+    };
+
+    Iterator begin() {
+        start = Clock::now();
+        return Iterator{ this };
+    }
+    Iterator end() { return Iterator{ this }; }
+
+    // Pixels handled per iteration; reported as megapixels per second
+    void setPixelsPerIteration(int64_t pixels) { pixelsPerIteration = pixels; }
+    void setLabel(const std::string& text) { label = text; }
+
+    int64_t iterations() const { return count; }
+    double secondsPerIteration() const {
+        return count == 0 ? 0.0 : std::chrono::duration<double>(elapsed).count() / static_cast<double>(count);
+    }
+    int64_t pixels() const { return pixelsPerIteration; }
+    const std::string& getLabel() const { return label; }
+
+private:
+    double minSeconds;
+    int64_t count = 0;
+    int64_t pixelsPerIteration = 0;
+    std::string label;
+    Clock::time_point start;
+    Clock::duration elapsed{};
+
+    bool keepRunning() {
+        Clock::duration spent = Clock::now() - start;
+        if (count > 0 && std::chrono::duration<double>(spent).count() >= minSeconds) {
+            elapsed = spent;
+            return false;
+        }
+        ++count;
+        return true;
+    }
+};
+
+struct BenchCase {
+    std::string name;
+    std::function<void(BenchState&)> body;
+};
+
+inline std::vector<BenchCase>& benchRegistry() {
+    static std::vector<BenchCase> cases;
+    return cases;
+}
+
+inline bool registerBenchmark(const std::string& name, std::function<void(BenchState&)> body) {
+    benchRegistry().push_back({ name, std::move(body) });
+    return true;
+}
+
+// Image sizes the suites sweep over, from preview-sized to 100 MP
+struct BenchSize {
+    const char* name;
+    int width, height;
+};
+
+inline const std::vector<BenchSize>& benchSizes() {
+    static const std::vector<BenchSize> sizes = {
+        { "0.3MP", 640, 480 },
+        { "1MP", 1280, 800 },
+        { "12MP", 4000, 3000 },
+        { "24MP", 6000, 4000 },
+        { "50MP", 8192, 6144 },
+        { "100MP", 10000, 10000 },
+    };
+    return sizes;
+}
+
+// Deterministic noise image so runs are comparable and need no input files
+inline cv::Mat syntheticImage(int width, int height, int type = CV_8UC3) {
+    cv::Mat image(height, width, type);
+    cv::theRNG().state = 0x5eed;
+    cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    return image;
+}
+
+// Smoothed noise: compresses and produces edges more like a photograph
+// than raw noise does, for codecs and edge detectors
+inline cv::Mat syntheticPhoto(int width, int height, int type = CV_8UC3) {
+    cv::Mat image = syntheticImage(width, height, type);
+    cv::GaussianBlur(image, image, cv::Size(7, 7), 0);
+    return image;
+}
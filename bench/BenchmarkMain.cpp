@@ -0,0 +1,63 @@
+// Runs the registered node benchmarks.
+//
+//   NodeBench [--filter <substring>] [--min-time <seconds>] [--list] [--csv]
+//
+// --csv prints one machine-readable line per benchmark, for comparing runs
+// against a stored baseline.
+
+#include "Benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minTime = 0.5;
+    bool list = false, csv = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            minTime = std::atof(argv[++i]);
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "--csv") {
+            csv = true;
+        } else {
+            std::fprintf(stderr, "Usage: NodeBench [--filter <substring>] [--min-time <seconds>] [--list] [--csv]\n");
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (csv) {
+        std::printf("name,iterations,ms_per_iter,mp_per_s,label\n");
+    } else if (!list) {
+        std::printf("%-48s %10s %12s %10s\n", "Benchmark", "Iters", "ms/iter", "MP/s");
+        std::printf("%s\n", std::string(83, '-').c_str());
+    }
+
+    for (const BenchCase& bench : benchRegistry()) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        if (list) {
+            std::printf("%s\n", bench.name.c_str());
+            continue;
+        }
+
+        BenchState state(minTime);
+        bench.body(state);
+
+        double ms = state.secondsPerIteration() * 1e3;
+        double mps = state.pixels() > 0 && ms > 0 ? state.pixels() / (ms * 1e3) : 0.0;
+        if (csv) {
+            std::printf("%s,%lld,%.4f,%.2f,%s\n", bench.name.c_str(),
+                        static_cast<long long>(state.iterations()), ms, mps, state.getLabel().c_str());
+        } else {
+            std::printf("%-48s %10lld %12.3f %10.1f %s\n", bench.name.c_str(),
+                        static_cast<long long>(state.iterations()), ms, mps, state.getLabel().c_str());
+        }
+        std::fflush(stdout);
+    }
+    return 0;
+}
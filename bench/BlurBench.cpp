@@ -0,0 +1,42 @@
+// BlurNode: exact Gaussian vs the three-pass box approximation across the
+// radius range the editor exposes, then across image sizes at the default
+// radius. The Gaussian's cost grows with the radius; the box passes should
+// stay flat.
+
+#include "Benchmark.h"
+#include "../nodes/BlurNode.h"
+
+namespace {
+
+const int WIDTH = 2048;
+const int HEIGHT = 1536;
+
+void blur(BenchState& state, int radius, BlurNode::Mode mode, int width = WIDTH, int height = HEIGHT) {
+    BlurNode node(radius, false);
+    node.setMode(mode);
+    std::vector<cv::Mat> inputs{ syntheticImage(width, height) };
+    for (auto _ : state) {
+        node.process(inputs);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+const bool registered = [] {
+    const int radii[] = { 1, 2, 5, 10, 15, 20 };
+    for (int r : radii) {
+        registerBenchmark("Blur/Gaussian/r" + std::to_string(r),
+                          [r](BenchState& state) { blur(state, r, BlurNode::GAUSSIAN); });
+        registerBenchmark("Blur/Box/r" + std::to_string(r),
+                          [r](BenchState& state) { blur(state, r, BlurNode::BOX_APPROX); });
+    }
+    for (const BenchSize& s : benchSizes()) {
+        int w = s.width, h = s.height;
+        registerBenchmark(std::string("Blur/Gaussian/r5/") + s.name,
+                          [w, h](BenchState& state) { blur(state, 5, BlurNode::GAUSSIAN, w, h); });
+        registerBenchmark(std::string("Blur/Box/r5/") + s.name,
+                          [w, h](BenchState& state) { blur(state, 5, BlurNode::BOX_APPROX, w, h); });
+    }
+    return true;
+}();
+
+} // namespace
@@ -0,0 +1,44 @@
+// BrightnessContrastNode: 256-entry LUT path vs the per-pixel convertTo path
+// it replaced, on 8-bit images.
+
+#include "Benchmark.h"
+#include "../nodes/BrightnessContrastNode.h"
+
+namespace {
+
+const double ALPHA = 1.3;
+const int BETA = 20;
+
+void convertToPath(BenchState& state, int width, int height) {
+    cv::Mat input = syntheticImage(width, height);
+    cv::Mat output;
+    for (auto _ : state) {
+        input.convertTo(output, -1, ALPHA, BETA);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+void lutPath(BenchState& state, int width, int height) {
+    BrightnessContrastNode node(ALPHA, BETA);
+    std::vector<cv::Mat> inputs{ syntheticImage(width, height) };
+    for (auto _ : state) {
+        node.process(inputs);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+const bool registered = [] {
+    const struct { const char* name; int width, height; } sizes[] = {
+        { "1MP", 1280, 800 }, { "12MP", 4000, 3000 }, { "24MP", 6000, 4000 },
+    };
+    for (const auto& s : sizes) {
+        int w = s.width, h = s.height;
+        registerBenchmark(std::string("BrightnessContrast/convertTo/") + s.name,
+                          [w, h](BenchState& state) { convertToPath(state, w, h); });
+        registerBenchmark(std::string("BrightnessContrast/LUT/") + s.name,
+                          [w, h](BenchState& state) { lutPath(state, w, h); });
+    }
+    return true;
+}();
+
+} // namespace
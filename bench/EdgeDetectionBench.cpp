@@ -0,0 +1,34 @@
+// EdgeDetectionNode: Sobel vs Canny across image sizes, and the Sobel
+// kernel sizes the editor offers at 12 MP. Inputs are smoothed noise so
+// Canny sees edges of a realistic density rather than one per pixel.
+
+#include "Benchmark.h"
+#include "../nodes/EdgeDetectionNode.h"
+
+namespace {
+
+void edges(BenchState& state, EdgeDetectionNode::Method method, int kernel, int width, int height) {
+    EdgeDetectionNode node(method, kernel);
+    std::vector<cv::Mat> inputs{ syntheticPhoto(width, height) };
+    for (auto _ : state) {
+        node.process(inputs);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+const bool registered = [] {
+    for (const BenchSize& s : benchSizes()) {
+        int w = s.width, h = s.height;
+        registerBenchmark(std::string("EdgeDetection/Sobel/") + s.name,
+                          [w, h](BenchState& state) { edges(state, EdgeDetectionNode::SOBEL, 3, w, h); });
+        registerBenchmark(std::string("EdgeDetection/Canny/") + s.name,
+                          [w, h](BenchState& state) { edges(state, EdgeDetectionNode::CANNY, 3, w, h); });
+    }
+    for (int k : { 1, 3, 5, 7 }) {
+        registerBenchmark("EdgeDetection/Sobel/k" + std::to_string(k) + "/12MP",
+                          [k](BenchState& state) { edges(state, EdgeDetectionNode::SOBEL, k, 4000, 3000); });
+    }
+    return true;
+}();
+
+} // namespace
@@ -0,0 +1,100 @@
+// Whole-graph evaluation of the editor's default pipeline (minus the file
+// writes) through GraphEngine, across image sizes and engine thread counts,
+// plus tiled mode at 12 MP and a small image where the engine's per-pass
+// overhead dominates. Fusion is measured on its own brightness/contrast ->
+// binary threshold chain, since the default pipeline has no two point-wise
+// nodes in a row. Every iteration swaps in the input image again so every
+// node is recomputed.
+
+#include "Benchmark.h"
+#include "../Graph.h"
+#include "../GraphEngine.h"
+#include "../nodes/ImageInputNode.h"
+#include "../nodes/BrightnessContrastNode.h"
+#include "../nodes/BlurNode.h"
+#include "../nodes/ThresholdNode.h"
+#include "../nodes/EdgeDetectionNode.h"
+#include "../nodes/ColorChannelSplitterNode.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+struct Pipeline {
+    Graph graph;
+    ImageInputNode* input = nullptr;
+};
+
+void buildPipeline(Pipeline& p) {
+    p.input = p.graph.add<ImageInputNode>();
+    BrightnessContrastNode* bc = p.graph.add<BrightnessContrastNode>(1.2, 10);
+    bc->inputs.push_back(p.input);
+    BlurNode* blur = p.graph.add<BlurNode>(5, false);
+    blur->inputs.push_back(bc);
+    ThresholdNode* threshold = p.graph.add<ThresholdNode>(128, ThresholdNode::BINARY);
+    threshold->inputs.push_back(blur);
+    EdgeDetectionNode* edges = p.graph.add<EdgeDetectionNode>(EdgeDetectionNode::SOBEL);
+    edges->inputs.push_back(threshold);
+    ColorChannelSplitterNode* splitter = p.graph.add<ColorChannelSplitterNode>(true);
+    splitter->inputs.push_back(threshold);
+    p.graph.sinks = { edges, splitter };
+}
+
+// Two point-wise nodes in a row, which fusion runs as one lookup table
+void buildPointwiseChain(Pipeline& p) {
+    p.input = p.graph.add<ImageInputNode>();
+    BrightnessContrastNode* bc = p.graph.add<BrightnessContrastNode>(1.2, 10);
+    bc->inputs.push_back(p.input);
+    ThresholdNode* threshold = p.graph.add<ThresholdNode>(128, ThresholdNode::BINARY);
+    threshold->inputs.push_back(bc);
+    p.graph.sinks = { threshold };
+}
+
+void evaluate(BenchState& state, void (*build)(Pipeline&), int width, int height, unsigned threads,
+              int tileSize, bool fusion) {
+    Pipeline pipeline;
+    build(pipeline);
+    GraphEngine engine(threads);
+    engine.setTileSize(tileSize);
+    engine.setFusion(fusion);
+
+    cv::Mat image = syntheticPhoto(width, height);
+    for (auto _ : state) {
+        pipeline.input->setImage(image);
+        engine.execute(pipeline.graph.sinks);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+std::vector<unsigned> threadCounts() {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t : { 1u, 2u, 4u, hardware }) {
+        if (t <= hardware && std::find(counts.begin(), counts.end(), t) == counts.end())
+            counts.push_back(t);
+    }
+    return counts;
+}
+
+const bool registered = [] {
+    for (const BenchSize& s : benchSizes()) {
+        for (unsigned t : threadCounts()) {
+            int w = s.width, h = s.height;
+            registerBenchmark(std::string("Graph/default/") + s.name + "/t" + std::to_string(t),
+                              [w, h, t](BenchState& state) { evaluate(state, buildPipeline, w, h, t, 0, true); });
+        }
+    }
+
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    registerBenchmark("Graph/tiled512/12MP",
+                      [hardware](BenchState& state) { evaluate(state, buildPipeline, 4000, 3000, hardware, 512, true); });
+    registerBenchmark("Graph/pointwise/fused/12MP",
+                      [hardware](BenchState& state) { evaluate(state, buildPointwiseChain, 4000, 3000, hardware, 0, true); });
+    registerBenchmark("Graph/pointwise/unfused/12MP",
+                      [hardware](BenchState& state) { evaluate(state, buildPointwiseChain, 4000, 3000, hardware, 0, false); });
+    registerBenchmark("Graph/small/64x64/t1",
+                      [](BenchState& state) { evaluate(state, buildPipeline, 64, 64, 1, 0, true); });
+    return true;
+}();
+
+} // namespace
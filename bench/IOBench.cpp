@@ -0,0 +1,84 @@
+// Image I/O: JPEG/PNG encode and decode in memory, and the file round trip
+// ImageInputNode and OutputNode go through. Sizes stop at 24 MP; beyond that
+// a single PNG encode takes several seconds.
+
+#include "Benchmark.h"
+#include "../nodes/ImageInputNode.h"
+#include <filesystem>
+
+namespace {
+
+const int64_t MAX_PIXELS = 24000000;
+
+std::vector<int> encodeParams(const std::string& ext) {
+    if (ext == ".jpg") return { cv::IMWRITE_JPEG_QUALITY, 90 };
+    return {};
+}
+
+void encode(BenchState& state, const std::string& ext, int width, int height) {
+    cv::Mat image = syntheticPhoto(width, height);
+    std::vector<uchar> buffer;
+    for (auto _ : state) {
+        cv::imencode(ext, image, buffer, encodeParams(ext));
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+    state.setLabel(std::to_string(buffer.size() / 1024) + " KiB");
+}
+
+void decode(BenchState& state, const std::string& ext, int width, int height) {
+    std::vector<uchar> buffer;
+    cv::imencode(ext, syntheticPhoto(width, height), buffer, encodeParams(ext));
+    cv::Mat image;
+    for (auto _ : state) {
+        image = cv::imdecode(buffer, cv::IMREAD_COLOR);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+std::string tempPath(const std::string& ext) {
+    return (std::filesystem::temp_directory_path() / ("nodebench" + ext)).string();
+}
+
+// What an OutputNode's write queue does per image
+void writeFile(BenchState& state, const std::string& ext, int width, int height) {
+    cv::Mat image = syntheticPhoto(width, height);
+    std::string path = tempPath(ext);
+    for (auto _ : state) {
+        cv::imwrite(path, image, encodeParams(ext));
+    }
+    std::filesystem::remove(path);
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+void readFile(BenchState& state, const std::string& ext, int width, int height) {
+    std::string path = tempPath(ext);
+    cv::imwrite(path, syntheticPhoto(width, height), encodeParams(ext));
+    ImageInputNode node;
+    for (auto _ : state) {
+        node.reload(path);
+    }
+    std::filesystem::remove(path);
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+const bool registered = [] {
+    using Body = void (*)(BenchState&, const std::string&, int, int);
+    const struct { const char* name; Body body; } stages[] = {
+        { "Encode", encode }, { "Decode", decode }, { "WriteFile", writeFile }, { "ReadFile", readFile },
+    };
+    for (const auto& stage : stages) {
+        for (const char* ext : { ".jpg", ".png" }) {
+            for (const BenchSize& s : benchSizes()) {
+                if (static_cast<int64_t>(s.width) * s.height > MAX_PIXELS) continue;
+                Body body = stage.body;
+                std::string format = ext;
+                int w = s.width, h = s.height;
+                registerBenchmark(std::string("IO/") + stage.name + "/" + (ext + 1) + "/" + s.name,
+                                  [body, format, w, h](BenchState& state) { body(state, format, w, h); });
+            }
+        }
+    }
+    return true;
+}();
+
+} // namespace
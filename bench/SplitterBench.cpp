@@ -0,0 +1,33 @@
+// ColorChannelSplitterNode: split with and without per-channel
+// normalization, then read every channel port the way consumers do.
+
+#include "Benchmark.h"
+#include "../nodes/ColorChannelSplitterNode.h"
+#include <algorithm>
+
+namespace {
+
+void split(BenchState& state, bool grayscale, int width, int height) {
+    ColorChannelSplitterNode node(grayscale);
+    std::vector<cv::Mat> inputs{ syntheticImage(width, height) };
+    const int channels = std::min(inputs[0].channels(), ColorChannelSplitterNode::CHANNEL_PORTS);
+    for (auto _ : state) {
+        node.process(inputs);
+        for (int port = 1; port <= channels; ++port)
+            node.getOutput(port);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+const bool registered = [] {
+    for (const BenchSize& s : benchSizes()) {
+        int w = s.width, h = s.height;
+        registerBenchmark(std::string("Splitter/Grayscale/") + s.name,
+                          [w, h](BenchState& state) { split(state, true, w, h); });
+        registerBenchmark(std::string("Splitter/Color/") + s.name,
+                          [w, h](BenchState& state) { split(state, false, w, h); });
+    }
+    return true;
+}();
+
+} // namespace
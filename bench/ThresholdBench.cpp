@@ -0,0 +1,33 @@
+// ThresholdNode: the three methods on 8-bit grayscale across image sizes.
+
+#include "Benchmark.h"
+#include "../nodes/ThresholdNode.h"
+
+namespace {
+
+void threshold(BenchState& state, int method, int width, int height) {
+    ThresholdNode node(128, method);
+    std::vector<cv::Mat> inputs{ syntheticImage(width, height, CV_8UC1) };
+    for (auto _ : state) {
+        node.process(inputs);
+    }
+    state.setPixelsPerIteration(static_cast<int64_t>(width) * height);
+}
+
+const bool registered = [] {
+    const struct { const char* name; int method; } methods[] = {
+        { "Binary", ThresholdNode::BINARY },
+        { "Adaptive", ThresholdNode::ADAPTIVE },
+        { "Otsu", ThresholdNode::OTSU },
+    };
+    for (const auto& m : methods) {
+        for (const BenchSize& s : benchSizes()) {
+            int method = m.method, w = s.width, h = s.height;
+            registerBenchmark(std::string("Threshold/") + m.name + "/" + s.name,
+                              [method, w, h](BenchState& state) { threshold(state, method, w, h); });
+        }
+    }
+    return true;
+}();
+
+} // namespace
@@ -1,19 +1,71 @@
 #include "BlurNode.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 
-BlurNode::BlurNode(int r, bool dir) : radius(r), directional(dir) {}
+BlurNode::BlurNode(int r, bool dir) : radius(r), directional(dir) {
+    name = "Blur";
+}
 
 void BlurNode::setParameters(int r, bool dir) {
-    radius = std::clamp(r, 1, 20);
+    r = std::clamp(r, 1, 20);
+    if (r == radius && dir == directional) return;
+
+    radius = r;
     directional = dir;
+    markDirty();
+}
+
+void BlurNode::setMode(Mode m) {
+    if (m == mode) return;
+    mode = m;
+    markDirty();
+}
+
+// Sigma cv::GaussianBlur derives from the kernel size when given sigma = 0
+double BlurNode::gaussianSigma(int r) {
+    int ksize = 2 * r + 1;
+    return 0.3 * ((ksize - 1) * 0.5 - 1) + 0.8;
+}
+
+// Widths of BOX_PASSES box filters whose combined variance matches the
+// Gaussian's: every pass uses the odd width wl or wl + 2, with the split
+// chosen so the summed variances ((w^2 - 1) / 12 each) equal sigma^2
+std::vector<int> BlurNode::boxWidths(int r) {
+    const int n = BOX_PASSES;
+    double sigma = gaussianSigma(r);
+    double ideal = std::sqrt(12.0 * sigma * sigma / n + 1.0);
+
+    int wl = static_cast<int>(std::floor(ideal));
+    if (wl % 2 == 0) wl--;
+    int wu = wl + 2;
+
+    double mIdeal = (12.0 * sigma * sigma - n * wl * wl - 4.0 * n * wl - 3.0 * n) / (-4.0 * wl - 4.0);
+    int m = static_cast<int>(std::lround(mIdeal));
+
+    std::vector<int> widths;
+    for (int i = 0; i < n; ++i)
+        widths.push_back(i < m ? wl : wu);
+    return widths;
 }
 
-cv::Mat BlurNode::getOutput() {
-    return output;
+int BlurNode::haloRadius() const {
+    int r = scaledLength(radius);
+    if (mode == GAUSSIAN) return r;
+
+    int halo = 0;
+    for (int w : boxWidths(r)) halo += w / 2;
+    return halo;
 }
 
 void BlurNode::showKernelPreview() {
+    if (mode == BOX_APPROX) {
+        std::cout << "Box passes approximating sigma " << gaussianSigma(radius) << ":";
+        for (int w : boxWidths(radius)) std::cout << " " << w;
+        std::cout << (directional ? " (horizontal)" : "") << std::endl;
+        return;
+    }
+
     int ksize = 2 * radius + 1;
     cv::Mat kernelX = cv::getGaussianKernel(ksize, -1, CV_32F);
 
@@ -26,15 +78,21 @@ void BlurNode::showKernelPreview() {
     }
 }
 
-void BlurNode::process() {
-    if (inputs.empty() || !inputs[0]) {
+void BlurNode::process(const std::vector<cv::Mat>& inputImages) {
+    process(inputImages, EvalContext());
+}
+
+// Work is split into bands of rows so a cancelled pass stops within one band.
+// Each band is filtered as a view into the full image, so OpenCV reads the
+// real neighbouring rows and the result matches a single full-image call.
+void BlurNode::process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) {
+    if (inputImages.empty()) {
         std::cerr << "[BlurNode] No input connected!\n";
         output = cv::Mat();
         return;
     }
 
-    inputs[0]->process();
-    cv::Mat inputImage = inputs[0]->getOutput();
+    const cv::Mat& inputImage = inputImages[0];
 
     if (inputImage.empty()) {
         std::cerr << "[BlurNode] Input image is empty!\n";
@@ -42,14 +100,34 @@ void BlurNode::process() {
         return;
     }
 
-    int ksize = 2 * radius + 1;
-    cv::Mat result;
+    // Proxy previews shrink the radius along with the image
+    int r = scaledLength(radius);
 
-    if (directional) {
-        cv::GaussianBlur(inputImage, result, cv::Size(ksize, 1), 0);
-    } else {
-        cv::GaussianBlur(inputImage, result, cv::Size(ksize, ksize), 0);
+    if (mode == BOX_APPROX) {
+        // Each cv::blur pass uses running sums, so the cost does not depend on the width
+        cv::Mat current = inputImage;
+        for (int w : boxWidths(r)) {
+            if (w <= 1) continue;
+            cv::Mat pass = context.buffer(current.size(), current.type());
+            cv::Size box = directional ? cv::Size(w, 1) : cv::Size(w, w);
+            context.forEachRowBand(current.rows, [&](cv::Range rows) {
+                cv::Mat band = pass.rowRange(rows);
+                cv::blur(current.rowRange(rows), band, box);
+            });
+            current = pass;
+        }
+        output = current.data == inputImage.data ? inputImage.clone() : current;
+        return;
     }
 
+    int ksize = 2 * r + 1;
+    cv::Mat result = context.buffer(inputImage.size(), inputImage.type());
+    cv::Size kernel = directional ? cv::Size(ksize, 1) : cv::Size(ksize, ksize);
+
+    context.forEachRowBand(inputImage.rows, [&](cv::Range rows) {
+        cv::Mat band = result.rowRange(rows);
+        cv::GaussianBlur(inputImage.rowRange(rows), band, kernel, 0);
+    });
+
     output = result;
 }
@@ -1,18 +1,39 @@
 #pragma once
 #include "Node.h"
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 class BlurNode : public Node {
+public:
+    enum Mode {
+        GAUSSIAN,    // Exact cv::GaussianBlur; cost grows with the radius
+        BOX_APPROX   // Repeated box filters; constant cost per pixel at any radius
+    };
+
+    // Number of box passes used by BOX_APPROX (three is visually Gaussian)
+    static const int BOX_PASSES = 3;
+
 private:
     int radius;
     bool directional;
-    cv::Mat output;
+    Mode mode = GAUSSIAN;
+
+    static double gaussianSigma(int r);
+    static std::vector<int> boxWidths(int r);
 
 public:
     BlurNode(int r = 5, bool dir = false);
+    std::unique_ptr<Node> clone() const override { return std::make_unique<BlurNode>(*this); }
 
     void setParameters(int r, bool dir);
+    void setMode(Mode m);
+    int getRadius() const { return radius; }
+    bool isDirectional() const { return directional; }
+    Mode getMode() const { return mode; }
     void showKernelPreview();
-    void process() override;
-    cv::Mat getOutput() override;
+    void process(const std::vector<cv::Mat>& inputImages) override;
+    void process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) override;
+
+    bool isTileable() const override { return true; }
+    int haloRadius() const override;
 };
@@ -5,29 +5,75 @@
 class BrightnessContrastNode : public Node {
     double alpha;  // Contrast (1.0 = no change)
     int beta;      // Brightness (0 = no change)
-    cv::Mat output;
+
+    // 8-bit fast path: alpha * x + beta has only 256 possible inputs, so it is
+    // tabulated once per parameter change and applied with a vectorized lookup
+    cv::Mat lut;
+
+    void rebuildLut() {
+        cv::Mat table;  // Fresh buffer: copies of this node may still share the old one
+        lutRamp().convertTo(table, -1, alpha, beta);
+        lut = table;
+    }
 
 public:
     // Constructor with default contrast and brightness values
     BrightnessContrastNode(double a = 1.0, int b = 0) : alpha(a), beta(b) {
         name = "BrightnessContrast";
+        rebuildLut();
+    }
+
+    // Copies share the table until their parameters change
+    std::unique_ptr<Node> clone() const override {
+        return std::make_unique<BrightnessContrastNode>(*this);
     }
 
     // Override process: adjust brightness and contrast
-    void process() override {
-        if (inputs.empty()) return;
-        cv::Mat input = inputs[0]->getOutput();
-        input.convertTo(output, -1, alpha, beta);  // Apply contrast and brightness
+    void process(const std::vector<cv::Mat>& inputImages) override {
+        if (inputImages.empty()) return;
+        const cv::Mat& input = inputImages[0];
+        if (input.depth() == CV_8U)
+            cv::LUT(input, lut, output);               // Same result as convertTo, one table read per pixel
+        else
+            input.convertTo(output, -1, alpha, beta);  // Apply contrast and brightness
     }
 
-    // Get the adjusted image
-    cv::Mat getOutput() override {
-        return output;
+    using Node::process;
+
+    // When the engine hands over the only reference to an 8-bit input, apply
+    // the table to it in place rather than writing a second image
+    void process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) override {
+        context.throwIfCancelled();
+        if (!inputImages.empty() && inputImages[0].depth() == CV_8U && context.canOverwrite(inputImages[0])) {
+            output = inputImages[0];
+            cv::LUT(output, lut, output);
+            return;
+        }
+        process(inputImages);
+    }
+
+    // Purely per-pixel, so any tile can be adjusted on its own
+    bool isTileable() const override {
+        return true;
+    }
+
+    bool isPointwise() const override {
+        return true;
+    }
+
+    cv::Mat pointwiseLut() const override {
+        return lut;
     }
 
     // Set parameters for brightness and contrast (optional)
     void setParameters(double a, int b) {
+        if (a == alpha && b == beta) return;
         alpha = a;
         beta = b;
+        rebuildLut();
+        markDirty();
     }
+
+    double getAlpha() const { return alpha; }
+    int getBeta() const { return beta; }
 };
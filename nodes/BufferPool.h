@@ -0,0 +1,131 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Recycles cv::Mat buffers between evaluations. The pool keeps a reference
+// to every buffer it hands out; once all other references are gone (the
+// node replaced its output, a scratch Mat went out of scope) the buffer is
+// free again and goes to the next request for the same size and type. There
+// is no explicit release: OpenCV's reference count is the free list.
+//
+// Buffers come back with stale contents. Free buffers beyond the byte budget
+// are dropped, least recently used first, and endPass() drops free buffers
+// nobody asked for during the last pass (e.g. after the image size changed).
+class BufferPool {
+public:
+    explicit BufferPool(size_t budgetBytes = size_t(1) << 30) : budget(budgetBytes) {}
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    cv::Mat acquire(int rows, int cols, int type) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++tick;
+        for (Entry& entry : entries) {
+            const cv::Mat& m = entry.mat;
+            if (m.rows == rows && m.cols == cols && m.type() == type && isFree(m)) {
+                entry.lastUse = tick;
+                ++hitCount;
+                return m;
+            }
+        }
+
+        ++missCount;
+        Entry entry{ cv::Mat(rows, cols, type), tick };
+        pooled += bytesOf(entry.mat);
+        entries.push_back(entry);
+        trim();
+        return entry.mat;
+    }
+
+    cv::Mat acquire(cv::Size size, int type) {
+        return acquire(size.height, size.width, type);
+    }
+
+    void setBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = bytes;
+        trim();
+    }
+
+    size_t budgetBytes() const { std::lock_guard<std::mutex> lock(mutex); return budget; }
+
+    // Called once a pass has finished: free buffers not handed out since the
+    // previous call are sizes the graph no longer asks for, so they go now
+    // rather than piling up to the budget. A pass that asked for nothing
+    // (everything cached) leaves the pool alone.
+    void endPass() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tick == passStart) return;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->lastUse <= passStart && isFree(it->mat)) {
+                pooled -= bytesOf(it->mat);
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        passStart = tick;
+    }
+
+    // Drop every buffer not currently in use
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t keep = budget;
+        budget = 0;
+        trim();
+        budget = keep;
+    }
+
+    // Whether `m` shares its data with a buffer handed out by this pool
+    bool owns(const cv::Mat& m) const {
+        if (!m.u) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const Entry& entry : entries) {
+            if (entry.mat.u == m.u) return true;
+        }
+        return false;
+    }
+
+    size_t pooledBytes() const { std::lock_guard<std::mutex> lock(mutex); return pooled; }
+    size_t hits() const { std::lock_guard<std::mutex> lock(mutex); return hitCount; }
+    size_t misses() const { std::lock_guard<std::mutex> lock(mutex); return missCount; }
+
+private:
+    struct Entry {
+        cv::Mat mat;
+        unsigned long long lastUse;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    size_t budget;
+    size_t pooled = 0;
+    unsigned long long tick = 0;
+    unsigned long long passStart = 0;  // `tick` at the last endPass()
+    size_t hitCount = 0, missCount = 0;
+
+    static size_t bytesOf(const cv::Mat& m) { return m.total() * m.elemSize(); }
+
+    // Only the pool's own reference left. Other holders may be releasing
+    // theirs concurrently, so read the count atomically.
+    static bool isFree(const cv::Mat& m) {
+        return m.u && CV_XADD(&m.u->refcount, 0) == 1;
+    }
+
+    // Caller holds the mutex
+    void trim() {
+        while (pooled > budget) {
+            auto victim = entries.end();
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (isFree(it->mat) && (victim == entries.end() || it->lastUse < victim->lastUse))
+                    victim = it;
+            }
+            if (victim == entries.end()) return;  // Everything left is in use
+            pooled -= bytesOf(victim->mat);
+            entries.erase(victim);
+        }
+    }
+};
@@ -3,11 +3,22 @@
 #include "opencv2/opencv.hpp"
 #include <vector>
 
+// Output ports: 0 is the whole image (channel 0 in grayscale mode, the
+// unchanged input otherwise), 1..CHANNEL_PORTS are the individual channels.
 class ColorChannelSplitterNode : public Node {
 private:
     std::vector<cv::Mat> channels; // To store the split channels
     bool grayscaleOutput;          // Whether to output grayscale versions of the channels or not
 
+    // If grayscale output is selected, normalize each channel to grayscale
+    void normalizeChannels() {
+        if (grayscaleOutput) {
+            for (auto& ch : channels) {
+                cv::normalize(ch, ch, 0, 255, cv::NORM_MINMAX);
+            }
+        }
+    }
+
 public:
     // Constructor: initializes with the option to output grayscale
     ColorChannelSplitterNode(bool grayscale = true)
@@ -15,9 +26,15 @@ public:
         name = "ColorChannelSplitter";
     }
 
+    std::unique_ptr<Node> clone() const override {
+        return std::make_unique<ColorChannelSplitterNode>(*this);
+    }
+
     // Setter for the grayscale output option
     void setGrayscaleOutput(bool value) {
+        if (value == grayscaleOutput) return;
         grayscaleOutput = value;
+        markDirty();
     }
 
     // Getter for the grayscale output option
@@ -26,26 +43,46 @@ public:
     }
 
     // Process method: splits the input image into channels and optionally normalizes to grayscale
-    void process() override {
-        if (inputs.empty() || !inputs[0]) {
+    void process(const std::vector<cv::Mat>& inputImages) override {
+        if (inputImages.empty()) {
             std::cerr << "[!] Splitter: No input!\n";
             return;
         }
 
-        cv::Mat input = inputs[0]->getOutput();
+        const cv::Mat& input = inputImages[0];
         if (input.empty()) {
             std::cerr << "[!] Splitter: Empty input!\n";
             return;
         }
 
+        output = grayscaleOutput ? cv::Mat() : input;  // Merging the planes again would only copy it
         cv::split(input, channels);  // Split the input into individual channels
+        normalizeChannels();
+    }
 
-        // If grayscale output is selected, normalize each channel to grayscale
-        if (grayscaleOutput) {
-            for (auto& ch : channels) {
-                cv::normalize(ch, ch, 0, 255, cv::NORM_MINMAX);
-            }
+    using Node::process;
+
+    // Planes come from the engine's buffer pool. A single-plane input is used
+    // as the channel directly, without the split copy, when it won't be
+    // normalized or the engine handed it over exclusively.
+    void process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) override {
+        context.throwIfCancelled();
+        if (inputImages.empty() || inputImages[0].empty()) {
+            process(inputImages);  // Reports the missing input
+            return;
+        }
+
+        const cv::Mat& input = inputImages[0];
+        output = grayscaleOutput ? cv::Mat() : input;
+        if (input.channels() == 1 && (!grayscaleOutput || context.canOverwrite(input))) {
+            channels.assign(1, input);
+        } else {
+            channels.resize(input.channels());
+            for (auto& ch : channels)
+                ch = context.buffer(input.size(), CV_MAKETYPE(input.depth(), 1));
+            cv::split(input, channels);
         }
+        normalizeChannels();
     }
 
     // Access individual channel (by index)
@@ -56,17 +93,33 @@ public:
         return cv::Mat();
     }
 
+    static const int CHANNEL_PORTS = 4;
+
+    int outputCount() const override { return 1 + CHANNEL_PORTS; }
+
+    std::string outputName(int port) const override {
+        if (port == 0) return "image";
+        return port <= CHANNEL_PORTS ? "channel " + std::to_string(port - 1) : "";
+    }
+
+    cv::Mat getOutput(int port) override {
+        return port == 0 ? getOutput() : getChannel(port - 1);
+    }
+
+    // The result is the channel list, not `output`
+    bool isMemoizable() const override { return false; }
+
+    void releaseOutput() override {
+        channels.clear();
+        output.release();
+    }
+
     // Override getOutput to return the first channel (default)
     cv::Mat getOutput() override {
         if (grayscaleOutput) {
             return getChannel(0);  // Default grayscale channel
         } else {
-            if (channels.size() == 3) {
-                cv::Mat merged;
-                cv::merge(channels, merged);
-                return merged;  // Return full color image
-            }
-            return cv::Mat();
+            return output;  // Full color image, as received
         }
     }
     
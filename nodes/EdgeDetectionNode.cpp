@@ -3,58 +3,76 @@
 #include <iostream>
 
 EdgeDetectionNode::EdgeDetectionNode(Method method, int kernelSize, double thresh1, double thresh2, bool overlay)
-    : method(method), kernelSize(kernelSize), threshold1(thresh1), threshold2(thresh2), overlayEdges(overlay) {}
+    : method(method), kernelSize(kernelSize), threshold1(thresh1), threshold2(thresh2), overlayEdges(overlay) {
+    name = "EdgeDetection";
+}
 
 void EdgeDetectionNode::setParameters(Method m, int kSize, double t1, double t2, bool overlay) {
+    if (m == method && kSize == kernelSize && t1 == threshold1 && t2 == threshold2 && overlay == overlayEdges)
+        return;
+
     method = m;
     kernelSize = kSize;
     threshold1 = t1;
     threshold2 = t2;
     overlayEdges = overlay;
+    markDirty();
+}
+
+void EdgeDetectionNode::process(const std::vector<cv::Mat>& inputImages) {
+    process(inputImages, EvalContext());
 }
 
-void EdgeDetectionNode::process() {
-    if (inputs.empty() || !inputs[0]) {
+void EdgeDetectionNode::process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) {
+    if (inputImages.empty()) {
         std::cerr << "EdgeDetectionNode: No input connected!\n";
         return;
     }
 
-    inputs[0]->process();
-    cv::Mat input = inputs[0]->getOutput();
+    const cv::Mat& input = inputImages[0];
     if (input.empty()) {
         std::cerr << "EdgeDetectionNode: Input image is empty!\n";
         return;
     }
 
-    cv::Mat gray, edges;
-    if (input.channels() == 3)
+    // Scratch and result buffers come from the pass's pool, so repeated
+    // evaluations at the same size don't allocate
+    cv::Mat gray;
+    if (input.channels() == 3) {
+        gray = context.buffer(input.size(), CV_8U);
         cv::cvtColor(input, gray, cv::COLOR_BGR2GRAY);
-    else
-        gray = input.clone();
+    } else {
+        gray = input;  // Only read from, so no copy
+    }
 
+    cv::Mat edges = context.buffer(gray.size(), CV_8U);
+    int ksize = scaledKernelSize();
     if (method == CANNY) {
-        cv::Canny(gray, edges, threshold1, threshold2, kernelSize);
+        // Hysteresis follows edges across the whole image, so Canny runs in one piece
+        context.throwIfCancelled();
+        cv::Canny(gray, edges, threshold1, threshold2, ksize);
     } else { // SOBEL
-        cv::Mat gradX, gradY;
-        cv::Sobel(gray, gradX, CV_16S, 1, 0, kernelSize);
-        cv::Sobel(gray, gradY, CV_16S, 0, 1, kernelSize);
-        cv::Mat absX, absY;
-        cv::convertScaleAbs(gradX, absX);
-        cv::convertScaleAbs(gradY, absY);
-        cv::addWeighted(absX, 0.5, absY, 0.5, 0, edges);
+        // Band by band, each band a view into `gray` so Sobel sees the real neighbouring rows
+        context.forEachRowBand(gray.rows, [&](cv::Range rows) {
+            cv::Size bandSize(gray.cols, rows.end - rows.start);
+            cv::Mat gradX = context.buffer(bandSize, CV_16S), gradY = context.buffer(bandSize, CV_16S);
+            cv::Sobel(gray.rowRange(rows), gradX, CV_16S, 1, 0, ksize);
+            cv::Sobel(gray.rowRange(rows), gradY, CV_16S, 0, 1, ksize);
+            cv::Mat absX = context.buffer(bandSize, CV_8U), absY = context.buffer(bandSize, CV_8U);
+            cv::convertScaleAbs(gradX, absX);
+            cv::convertScaleAbs(gradY, absY);
+            cv::Mat band = edges.rowRange(rows);
+            cv::addWeighted(absX, 0.5, absY, 0.5, 0, band);
+        });
     }
 
     if (overlayEdges) {
-        cv::Mat colorEdges;
+        cv::Mat colorEdges = context.buffer(edges.size(), CV_8UC3);
         cv::cvtColor(edges, colorEdges, cv::COLOR_GRAY2BGR);
-        cv::Mat blended;
+        cv::Mat blended = context.buffer(input.size(), input.type());
         cv::addWeighted(input, 0.8, colorEdges, 0.2, 0, blended);
         output = blended;
     } else {
         output = edges;
     }
 }
-
-cv::Mat EdgeDetectionNode::getOutput() {
-    return output;
-}
@@ -10,17 +10,35 @@ public:
     };
 
     EdgeDetectionNode(Method method = CANNY, int kernelSize = 3, double thresh1 = 100, double thresh2 = 200, bool overlay = false);
+    std::unique_ptr<Node> clone() const override { return std::make_unique<EdgeDetectionNode>(*this); }
 
     void setParameters(Method method, int kernelSize, double thresh1, double thresh2, bool overlay);
-    void process() override;
-    cv::Mat getOutput() override;
+    Method getMethod() const { return method; }
+    int getKernelSize() const { return kernelSize; }
+    double getThreshold1() const { return threshold1; }
+    double getThreshold2() const { return threshold2; }
+    bool getOverlayEdges() const { return overlayEdges; }
+    void process(const std::vector<cv::Mat>& inputImages) override;
+    void process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) override;
+
+    // Canny's hysteresis can follow an edge across the whole image
+    bool isTileable() const override { return method == SOBEL; }
+    int haloRadius() const override {
+        // A 1-tap Sobel still differentiates with a 3-tap [-1 0 1] stencil.
+        // Canny adds one pixel for non-maximum suppression and one for each
+        // hysteresis step; how far hysteresis travels is unbounded, which is
+        // why it isn't tileable.
+        int sobel = std::max(1, scaledKernelSize() / 2);
+        return method == CANNY ? sobel + 2 : sobel;
+    }
 
 private:
+    // Kernel size at the current preview level; Canny needs an aperture of at least 3
+    int scaledKernelSize() const { return scaledOddSize(kernelSize, method == CANNY ? 3 : 1); }
+
     Method method;
     int kernelSize;
     double threshold1;
     double threshold2;
     bool overlayEdges;
-
-    cv::Mat output;
 };
@@ -0,0 +1,67 @@
+#pragma once
+#include "BufferPool.h"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+// Thrown out of process() when the evaluation it belongs to was cancelled
+struct EvaluationCancelled : std::runtime_error {
+    EvaluationCancelled() : std::runtime_error("evaluation cancelled") {}
+};
+
+// Shared flag the owner of an evaluation raises to abandon it. Cancellation
+// is cooperative: GraphEngine checks it between nodes and tiles, and
+// long-running kernels check it between bands of rows.
+class CancellationToken {
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    void reset() { cancelled.store(false, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled{false};
+};
+
+// Per-pass state the engine hands to every node it runs
+struct EvalContext {
+    const CancellationToken* cancel = nullptr;
+    BufferPool* pool = nullptr;
+
+    // Output or scratch buffer of the given shape, recycled from the pool
+    // when there is one. Contents are unspecified.
+    cv::Mat buffer(cv::Size size, int type) const {
+        return pool ? pool->acquire(size, type) : cv::Mat(size, type);
+    }
+
+    // In-place execution: true when `input` holds the only reference to its
+    // data apart from the pool's, so a node may write its result into it.
+    // The engine arranges this for the last reader of a released output;
+    // sources, cached results and anything still being read never qualify.
+    bool canOverwrite(const cv::Mat& input) const {
+        if (!input.u || input.empty()) return false;
+        int owners = pool && pool->owns(input) ? 2 : 1;
+        return CV_XADD(&input.u->refcount, 0) == owners;
+    }
+
+    bool isCancelled() const { return cancel && cancel->isCancelled(); }
+
+    void throwIfCancelled() const {
+        if (isCancelled()) throw EvaluationCancelled();
+    }
+
+    // Rows per band when a kernel splits its work to stay cancellable
+    static const int BAND_ROWS = 128;
+
+    // Call `body(rows)` over consecutive bands of [0, rows), checking for
+    // cancellation before each. Without a token the whole range is one band,
+    // so uncancellable passes keep OpenCV's full-image fast paths.
+    template <typename Body>
+    void forEachRowBand(int rows, Body body) const {
+        int band = cancel ? BAND_ROWS : std::max(rows, 1);
+        for (int y = 0; y < rows; y += band) {
+            throwIfCancelled();
+            body(cv::Range(y, std::min(rows, y + band)));
+        }
+    }
+};
@@ -5,12 +5,20 @@
 class ImageInputNode : public Node {
 private:
     cv::Mat image;  // The image data
+    std::string path;
+    std::vector<cv::Mat> pyramid;  // pyramid[n - 1] is the image at preview level n; built on demand
 
 public:
-    // Constructor: takes the file path and loads the image
-    ImageInputNode(const std::string& filename) {
+    // Constructor: takes the file path and loads the image (none if empty)
+    ImageInputNode(const std::string& filename = "") {
         name = "ImageInput";
-        loadImage(filename);  // Load image from disk
+        if (!filename.empty())
+            loadImage(filename);  // Load image from disk
+    }
+
+    // Copies share the pixels; setImage/loadImage replace rather than modify them
+    std::unique_ptr<Node> clone() const override {
+        return std::make_unique<ImageInputNode>(*this);
     }
 
     // Reload the image from the specified filename
@@ -21,23 +29,69 @@ public:
     // Helper method to load the image from the given filename
     void loadImage(const std::string& filename) {
         image = cv::imread(filename);  // Load image from disk
+        path = filename;
+        pyramid.clear();
+        markDirty();                   // Everything downstream must be recomputed
         if (image.empty()) {
             std::cerr << "Error: Unable to load image at " << filename << std::endl;
         }
     }
 
-    // Override process, but we don't need to do anything here (input node just loads)
-    void process() override {
-        // No processing needed for this node
+    // Use an image that is already in memory (batch drivers, tests)
+    void setImage(const cv::Mat& img, const std::string& source = "") {
+        image = img;
+        path = source;
+        pyramid.clear();
+        markDirty();
     }
 
+    // At full resolution there is nothing to do (input node just loads). For
+    // proxy previews, pick the pyramid level, halving the image as needed;
+    // levels are kept, so moving between levels later costs nothing.
+    void process(const std::vector<cv::Mat>&) override {
+        output = cv::Mat();
+        if (previewLevel == 0 || image.empty()) return;
+
+        while (static_cast<int>(pyramid.size()) < previewLevel) {
+            const cv::Mat& previous = pyramid.empty() ? image : pyramid.back();
+            if (previous.cols < 2 || previous.rows < 2) break;
+            cv::Mat half;
+            cv::pyrDown(previous, half);
+            pyramid.push_back(half);
+        }
+        output = pyramid.empty() ? image : pyramid[std::min<size_t>(previewLevel, pyramid.size()) - 1];
+    }
+
+    using Node::getOutput;
+
     // Get the image (output of the node)
     cv::Mat getOutput() override {
+        return previewLevel == 0 ? image : output;
+    }
+
+    // Full-resolution image, whatever the preview level
+    const cv::Mat& getImage() const {
         return image;
     }
 
+    // Smallest preview level at which the image has at most `maxPixels` pixels
+    int proxyLevel(double maxPixels) const {
+        int level = 0;
+        double pixels = static_cast<double>(image.total());
+        while (pixels > maxPixels && level < 8) {
+            pixels /= 4;
+            ++level;
+        }
+        return level;
+    }
+
+    // Path the current image came from (empty if none)
+    const std::string& getPath() const {
+        return path;
+    }
+
     // Get the current filename of the loaded image (if needed in the GUI)
     std::string getFilename() const {
-        return image.empty() ? "No image loaded" : "Image Loaded";
+        return image.empty() ? "No image loaded" : path;
     }
 };
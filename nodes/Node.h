@@ -1,5 +1,8 @@
 #pragma once
 #include "opencv2/opencv.hpp"
+#include "EvalContext.h"
+#include <algorithm>
+#include <memory>
 #include <vector>
 #include <string>
 using namespace std;
@@ -9,12 +12,112 @@ class Node{
         string name;
         vector<Node*> inputs;
 
-        // Virtual function: must be implemented by derived (child) classes
-        virtual void process() = 0;
+        // Output port each input reads, by position in `inputs`; missing
+        // entries mean port 0. Set through connect() for other ports.
+        vector<int> inputPorts;
 
-        // Virtual function to get the result of this node
-        virtual cv::Mat getOutput() = 0;
+        // Append an input reading `port` of `source`
+        void connect(Node* source, int port = 0) {
+            if (port != 0 || !inputPorts.empty()) {
+                inputPorts.resize(inputs.size(), 0);
+                inputPorts.push_back(port);
+            }
+            inputs.push_back(source);
+        }
+
+        int inputPort(size_t input) const {
+            return input < inputPorts.size() ? inputPorts[input] : 0;
+        }
+
+        // Bumped whenever a parameter changes, so the engine knows the cached output is stale
+        unsigned long long version = 0;
+        void markDirty() { ++version; }
+
+        // Compute this node's output from the already-evaluated outputs of its
+        // inputs (same order as `inputs`). Nodes never evaluate their inputs
+        // themselves; GraphEngine is the only scheduler.
+        virtual void process(const vector<cv::Mat>& inputImages) = 0;
+
+        // What the engine actually calls. Nodes with long-running kernels
+        // override it to check context.cancel as they go (add
+        // `using Node::process;` to keep the plain overload visible).
+        virtual void process(const vector<cv::Mat>& inputImages, const EvalContext& context) {
+            context.throwIfCancelled();
+            process(inputImages);
+        }
+
+        // Result of the last process() call
+        virtual cv::Mat getOutput() { return output; }
+
+        // Output ports: most nodes have one, port 0, which is getOutput().
+        // Nodes producing several images expose each on its own port so
+        // consumers can connect to just the one they need.
+        virtual int outputCount() const { return 1; }
+        virtual string outputName(int port) const { return port == 0 ? "image" : ""; }
+        virtual cv::Mat getOutput(int port) { return port == 0 ? getOutput() : cv::Mat(); }
+
+        // Independent copy for another worker: same parameters (large read-only
+        // data such as tables and source images stays shared), no result, and
+        // still pointing at the original's inputs until Graph::clone rewires
+        // it. Nodes that can't be copied return nullptr.
+        virtual std::unique_ptr<Node> clone() const { return nullptr; }
+
+        // Whether the engine may store this node's result in its memo cache and
+        // restore it by assigning `output`. Nodes with side effects, or whose
+        // result lives elsewhere, opt out.
+        virtual bool isMemoizable() const { return true; }
+
+        // Drop the result to free its memory. The engine does this once every
+        // reader in a pass is done with it, and recomputes the node if needed again.
+        virtual void releaseOutput() { output.release(); }
+
+        // Tiled execution: whether this node's result can be computed one tile
+        // at a time (it only looks at a bounded neighbourhood and keeps the image
+        // size), and how many pixels around each output pixel it reads.
+        virtual bool isTileable() const { return false; }
+        virtual int haloRadius() const { return 0; }
+
+        // Fusion: point-wise nodes whose effect on 8-bit images is a fixed
+        // per-value mapping return it as a 1x256 CV_8U table, built by running
+        // the node's own operation on a 0..255 ramp so fused results match exactly.
+        virtual bool isPointwise() const { return false; }
+        virtual cv::Mat pointwiseLut() const { return cv::Mat(); }
+
+        // Proxy preview: at level n, sources emit their image downscaled by 2^n
+        // and nodes with parameters measured in pixels (radii, kernel sizes)
+        // shrink them to match, so a proxy render looks like a scaled-down
+        // full render. Level 0 is full resolution.
+        void setPreviewLevel(int level) {
+            if (level == previewLevel) return;
+            previewLevel = level > 0 ? level : 0;
+            markDirty();
+        }
+        int getPreviewLevel() const { return previewLevel; }
+        double resolutionScale() const { return 1.0 / (1 << previewLevel); }
+
+        static cv::Mat lutRamp() {
+            cv::Mat ramp(1, 256, CV_8U);
+            for (int i = 0; i < 256; ++i) ramp.at<uchar>(i) = static_cast<uchar>(i);
+            return ramp;
+        }
     
         // Virtual destructor for safe cleanup
         virtual ~Node() = default;
+
+    protected :
+        cv::Mat output;
+        int previewLevel = 0;
+
+        // A length given in full-resolution pixels, at the current level
+        int scaledLength(int pixels, int minimum = 1) const {
+            return std::max(minimum, cvRound(pixels * resolutionScale()));
+        }
+
+        // Same for odd kernel sizes
+        int scaledOddSize(int size, int minimum = 1) const {
+            int scaled = 2 * cvRound((size * resolutionScale() - 1) * 0.5) + 1;
+            return std::max(minimum, scaled);
+        }
+
+        friend class GraphEngine;
 };
@@ -1,16 +1,36 @@
 #pragma once
 #include "Node.h"
+#include "../ImageWriteQueue.h"
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
+#ifdef _WIN32
 #include <direct.h>
+#endif
 
 
 class OutputNode : public Node {
     std::string filename;
     std::string format; // jpg, png, bmp
     int jpgQuality; // for .jpg
-    cv::Mat output;
+    std::string queuedPath; // File the current output was last handed to the write queue for
+
+    std::vector<int> encodeParams() const {
+        std::vector<int> params;
+        if (format == "jpg" || format == "jpeg") {
+            params.push_back(cv::IMWRITE_JPEG_QUALITY);
+            params.push_back(jpgQuality); // 0 to 100
+        }
+        return params;
+    }
+
+    // `output` shares the upstream node's buffer, and nodes such as Threshold
+    // and BrightnessContrast create() their next result into that same buffer,
+    // so the queue gets its own copy; the copy is cheap next to the encode
+    void enqueueWrite(const std::string& fullFilename) {
+        ImageWriteQueue::shared().push(fullFilename, output.clone(), encodeParams());
+        queuedPath = fullFilename;
+    }
 
 public:
     OutputNode(const std::string& file, const std::string& fmt = "jpg", int quality = 95)
@@ -18,60 +38,59 @@ public:
         name = "OutputNode";
     }
 
-    void process() override {
+    std::unique_ptr<Node> clone() const override {
+        return std::make_unique<OutputNode>(*this);
+    }
+
+    // Writing the file is the point, so a cached result is no substitute
+    bool isMemoizable() const override { return false; }
+
+    void process(const std::vector<cv::Mat>& inputImages) override {
         std::cout << "OutputNode process called\n";
     
-        if (inputs.empty()) {
+        if (inputImages.empty()) {
             std::cerr << "No input connected!\n";
             return;
         }
     
-        output = inputs[0]->getOutput();
+        output = inputImages[0];
+        queuedPath.clear();
         if (output.empty()) {
             std::cerr << "Empty image received from input node!\n";
             return;
         }
     
-        std::vector<int> params;
-    
-        if (format == "jpg" || format == "jpeg") {
-            params.push_back(cv::IMWRITE_JPEG_QUALITY);
-            params.push_back(jpgQuality); // 0 to 100
-        }
-    
         std::string fullFilename = filename + "." + format;
     
-        std::cout << "Attempting to save: " << fullFilename << std::endl;
-    
-        bool success = cv::imwrite(fullFilename, output, params);
-        if (success) {
-            std::cout << "[✔] Image saved to: " << fullFilename << std::endl;
-        } else {
-            std::cerr << "[✘] Failed to save image!" << std::endl;
-        }
+        // Encoding and disk I/O happen on the write queue's threads, so the
+        // graph can move on while this image is compressed
+        std::cout << "Queueing save: " << fullFilename << std::endl;
+        enqueueWrite(fullFilename);
     }
     // OutputNode.h
+    // Write the current output and wait until it is on disk. If process()
+    // already queued this exact result, it is not encoded a second time.
     void save() {
         if (!output.empty()) {
-            std::vector<int> params;
-            if (format == "jpg" || format == "jpeg") {
-                params.push_back(cv::IMWRITE_JPEG_QUALITY);
-                params.push_back(jpgQuality); // Use jpgQuality instead of quality
-            }
-            cv::imwrite(filename + "." + format, output, params);  // Use filename, not name
+            std::string fullFilename = filename + "." + format;
+            if (queuedPath != fullFilename)
+                enqueueWrite(fullFilename);
+            ImageWriteQueue::shared().flush();
         }
     }
     
     
 
-    cv::Mat getOutput() override {
-        return output;
+    void showPreview() {
+        showPreview(output);
     }
 
-    void showPreview() {
-        if (!output.empty()) {
-            std::cout << "Previewing image: " << output.cols << "x" << output.rows << std::endl;
-            cv::imshow("Output Preview", output);
+    // HighGUI windows belong to the UI thread; callers evaluating elsewhere
+    // pass a copy of the output here instead
+    static void showPreview(const cv::Mat& image) {
+        if (!image.empty()) {
+            std::cout << "Previewing image: " << image.cols << "x" << image.rows << std::endl;
+            cv::imshow("Output Preview", image);
             cv::waitKey(1);  // Allows processing of other events
         } else {
             std::cerr << "Error: Output image is empty!" << std::endl;
@@ -79,7 +98,11 @@ public:
     }
     
 
-    void setFilename(const std::string& f) { filename = f; }
-    void setFormat(const std::string& f) { format = f; }
-    void setQuality(int q) { jpgQuality = q; }
+    const std::string& getFilename() const { return filename; }
+    const std::string& getFormat() const { return format; }
+    int getQuality() const { return jpgQuality; }
+
+    void setFilename(const std::string& f) { if (f != filename) { filename = f; queuedPath.clear(); markDirty(); } }
+    void setFormat(const std::string& f) { if (f != format) { format = f; queuedPath.clear(); markDirty(); } }
+    void setQuality(int q) { if (q != jpgQuality) { jpgQuality = q; queuedPath.clear(); markDirty(); } }
 };
@@ -3,11 +3,16 @@
 #include <opencv2/opencv.hpp>
 
 ThresholdNode::ThresholdNode(double tValue, int method) 
-    : thresholdValue(tValue), thresholdMethod(method) {}
+    : thresholdValue(tValue), thresholdMethod(method) {
+    name = "Threshold";
+}
 
 void ThresholdNode::setParameters(double tValue, int method) {
+    if (tValue == thresholdValue && method == thresholdMethod) return;
+
     thresholdValue = tValue;
     thresholdMethod = method;
+    markDirty();
 }
 
 void ThresholdNode::showHistogram() {
@@ -16,7 +21,7 @@ void ThresholdNode::showHistogram() {
         return;
     }
 
-    inputs[0]->process();
+    // Uses the input's last evaluated output; run the graph first
     cv::Mat inputImage = inputs[0]->getOutput();
 
     if (inputImage.empty()) {
@@ -49,15 +54,32 @@ void ThresholdNode::showHistogram() {
     cv::waitKey(0);  // Wait for key press to close histogram window
 }
 
-void ThresholdNode::process() {
-    if (inputs.empty() || !inputs[0]) {
+cv::Mat ThresholdNode::pointwiseLut() const {
+    cv::Mat lut;
+    cv::threshold(lutRamp(), lut, thresholdValue, 255, cv::THRESH_BINARY);
+    return lut;
+}
+
+// The binary threshold keeps type and size, so it can overwrite an input
+// the engine handed over exclusively
+void ThresholdNode::process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) {
+    context.throwIfCancelled();
+    if (thresholdMethod == BINARY && !inputImages.empty() && context.canOverwrite(inputImages[0])) {
+        output = inputImages[0];
+        cv::threshold(output, output, thresholdValue, 255, cv::THRESH_BINARY);
+        return;
+    }
+    process(inputImages);
+}
+
+void ThresholdNode::process(const std::vector<cv::Mat>& inputImages) {
+    if (inputImages.empty()) {
         std::cerr << "[ThresholdNode] No input connected!\n";
         output = cv::Mat();
         return;
     }
 
-    inputs[0]->process();
-    cv::Mat inputImage = inputs[0]->getOutput();
+    const cv::Mat& inputImage = inputImages[0];
 
     if (inputImage.empty()) {
         std::cerr << "[ThresholdNode] Input image is empty!\n";
@@ -72,7 +94,7 @@ void ThresholdNode::process() {
             break;
         case ADAPTIVE:
             cv::adaptiveThreshold(inputImage, output, 255, cv::ADAPTIVE_THRESH_MEAN_C, 
-                cv::THRESH_BINARY, 11, 2);
+                cv::THRESH_BINARY, adaptiveBlockSize(), 2);
             break;
         case OTSU:
             cv::threshold(inputImage, output, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
@@ -83,7 +105,3 @@ void ThresholdNode::process() {
             break;
     }
 }
-
-cv::Mat ThresholdNode::getOutput() {
-    return output;
-}
@@ -7,20 +7,35 @@
 class ThresholdNode : public Node {
 public:
     ThresholdNode(double tValue = 128, int method = BINARY);  // Default to BINARY
+    std::unique_ptr<Node> clone() const override { return std::make_unique<ThresholdNode>(*this); }
     void setParameters(double tValue, int method);
+    double getThresholdValue() const { return thresholdValue; }
+    int getMethod() const { return thresholdMethod; }
     void showHistogram();
-    void process() override;
-    cv::Mat getOutput() override;
+    void process(const std::vector<cv::Mat>& inputImages) override;
+    void process(const std::vector<cv::Mat>& inputImages, const EvalContext& context) override;
+
+    // Otsu picks its threshold from the whole image's histogram
+    bool isTileable() const override { return thresholdMethod != OTSU; }
+    int haloRadius() const override { return thresholdMethod == ADAPTIVE ? adaptiveBlockSize() / 2 : 0; }
+
+    // Only the fixed-value binary threshold is a per-pixel mapping
+    bool isPointwise() const override { return thresholdMethod == BINARY; }
+    cv::Mat pointwiseLut() const override;
 
     // Constants to represent different thresholding methods
     static const int BINARY = 0;
     static const int ADAPTIVE = 1;
     static const int OTSU = 2;
 
+    static const int ADAPTIVE_BLOCK_SIZE = 11;
+
 private:
     double thresholdValue;
     int thresholdMethod;
-    cv::Mat output;
+
+    // Neighbourhood of the adaptive method, shrunk for proxy previews
+    int adaptiveBlockSize() const { return scaledOddSize(ADAPTIVE_BLOCK_SIZE, 3); }
 };
 
 #endif
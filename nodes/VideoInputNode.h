@@ -0,0 +1,77 @@
+#pragma once
+#include "ImageInputNode.h"
+#include "../FrameReader.h"
+#include <memory>
+#include <string>
+
+// Source node for video files and numbered image sequences. Frames are
+// decoded ahead on a background thread (see FrameReader); nextFrame()
+// makes the next one the node's image, marking everything downstream
+// dirty. Proxy previews work as for still images.
+class VideoInputNode : public ImageInputNode {
+private:
+    std::unique_ptr<FrameReader> reader;
+    std::string source;
+    long frameIndex = -1;
+
+public:
+    // Frames decoded ahead of the graph
+    static constexpr size_t RING_SIZE = 4;
+
+    VideoInputNode(const std::string& videoSource = "") {
+        name = "VideoInput";
+        if (!videoSource.empty())
+            open(videoSource);
+    }
+
+    // Copies show the same frame but don't decode: drivers feed them with setFrame
+    VideoInputNode(const VideoInputNode& other)
+        : ImageInputNode(other), source(other.source), frameIndex(other.frameIndex) {}
+
+    std::unique_ptr<Node> clone() const override {
+        return std::make_unique<VideoInputNode>(*this);
+    }
+
+    // Start streaming from `videoSource` and show its first frame
+    bool open(const std::string& videoSource) {
+        source = videoSource;
+        frameIndex = -1;
+        reader = std::make_unique<FrameReader>(videoSource, RING_SIZE);
+        if (!reader->isOpened()) {
+            std::cerr << "Error: Unable to open video at " << videoSource << std::endl;
+            setImage(cv::Mat(), videoSource);
+            return false;
+        }
+        return nextFrame();
+    }
+
+    // Remember the source without decoding anything (drivers that feed
+    // frames themselves through setFrame)
+    void setSource(const std::string& videoSource) {
+        reader.reset();
+        source = videoSource;
+        frameIndex = -1;
+        setImage(cv::Mat(), videoSource);
+    }
+
+    // Advance to the next frame; false (keeping the last frame) at the end
+    bool nextFrame() {
+        FrameReader::Frame frame;
+        if (!reader || !reader->next(frame)) return false;
+        setFrame(frame.image, frame.index);
+        return true;
+    }
+
+    // Use a frame decoded elsewhere
+    void setFrame(const cv::Mat& frame, long index) {
+        frameIndex = index;
+        setImage(frame, source);
+    }
+
+    bool rewind() { return !source.empty() && open(source); }
+
+    long getFrameIndex() const { return frameIndex; }
+    double getFps() const { return reader ? reader->fps() : 0; }
+    long getFrameCount() const { return reader ? reader->frameCount() : 0; }
+    const std::string& getSource() const { return source; }
+};
@@ -0,0 +1,109 @@
+#include "PreviewTexture.h"
+#include <cstring>
+#include <iostream>
+
+bool PreviewTexture::upload(const cv::Mat& source) {
+    if (source.empty()) return false;
+
+    cv::Mat image = source;
+    if (image.depth() != CV_8U)
+        image.convertTo(image, CV_8U);
+
+    GLenum format;
+    GLint internalFormat;
+    switch (image.channels()) {
+        case 1: format = GL_LUMINANCE; internalFormat = GL_RGB8;  break;  // Gray shown as gray, not red
+        case 3: format = GL_BGR;       internalFormat = GL_RGB8;  break;
+        case 4: format = GL_BGRA;      internalFormat = GL_RGBA8; break;
+        default:
+            std::cerr << "[✘] Preview: unsupported channel count " << image.channels() << std::endl;
+            return false;
+    }
+
+    if (texture == 0) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+
+    // Reallocate storage only when the shape changes
+    if (image.cols != texWidth || image.rows != texHeight || format != texFormat) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.cols, image.rows, 0, format, GL_UNSIGNED_BYTE, nullptr);
+        texWidth = image.cols;
+        texHeight = image.rows;
+        texFormat = format;
+    }
+
+    if (pixelBuffers && GLAD_GL_VERSION_3_0)
+        uploadThroughPbo(image, format);
+    else
+        uploadDirect(image, format);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void PreviewTexture::uploadDirect(const cv::Mat& image, GLenum format) {
+    // Rows of OpenCV images are not padded to 4 bytes, and ROIs have a stride
+    // wider than the row itself
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(image.step / image.elemSize()));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.cols, image.rows, format, GL_UNSIGNED_BYTE, image.data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void PreviewTexture::uploadThroughPbo(const cv::Mat& image, GLenum format) {
+    const size_t rowBytes = image.cols * image.elemSize();
+    const size_t bytes = rowBytes * image.rows;
+
+    if (pbos[0] == 0)
+        glGenBuffers(PBO_COUNT, pbos);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    // Orphan the old storage: if the GPU is still reading the previous upload
+    // from this buffer, the driver hands out fresh memory instead of waiting
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (!mapped) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        uploadDirect(image, format);
+        return;
+    }
+
+    if (image.isContinuous()) {
+        std::memcpy(mapped, image.data, bytes);
+    } else {
+        for (int y = 0; y < image.rows; ++y)
+            std::memcpy(static_cast<unsigned char*>(mapped) + y * rowBytes, image.ptr(y), rowBytes);
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // With a buffer bound, the pointer argument is an offset into it
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.cols, image.rows, format, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    nextPbo = (nextPbo + 1) % PBO_COUNT;
+}
+
+void PreviewTexture::release() {
+    if (pbos[0] != 0) {
+        glDeleteBuffers(PBO_COUNT, pbos);
+        for (GLuint& pbo : pbos) pbo = 0;
+        nextPbo = 0;
+    }
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    texWidth = texHeight = 0;
+    texFormat = 0;
+}
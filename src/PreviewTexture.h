@@ -0,0 +1,45 @@
+#pragma once
+#include <glad/glad.h>
+#include <opencv2/opencv.hpp>
+
+// GL texture that shows one output's preview. Storage is allocated once and
+// reused as long as the image size and channel count stay the same; new
+// frames are uploaded with glTexSubImage2D. When pixel buffer objects are
+// available, uploads go through a small ring of them so the copy into GL
+// memory returns immediately and the transfer overlaps with the next frame.
+//
+// Needs a current GL context (and gladLoadGLLoader) for every call,
+// including release(), which must run before the context is destroyed.
+class PreviewTexture {
+public:
+    explicit PreviewTexture(bool usePixelBuffers = true) : pixelBuffers(usePixelBuffers) {}
+    ~PreviewTexture() { release(); }
+
+    PreviewTexture(const PreviewTexture&) = delete;
+    PreviewTexture& operator=(const PreviewTexture&) = delete;
+
+    // Upload an 8-bit 1, 3 or 4 channel (gray, BGR, BGRA) image. Other depths
+    // are converted to 8-bit first. Returns false for empty or unsupported input.
+    bool upload(const cv::Mat& image);
+
+    // Delete the texture and pixel buffers
+    void release();
+
+    GLuint id() const { return texture; }
+    int width() const { return texWidth; }
+    int height() const { return texHeight; }
+
+private:
+    static const int PBO_COUNT = 2;
+
+    bool pixelBuffers;
+    GLuint texture = 0;
+    int texWidth = 0, texHeight = 0;
+    GLenum texFormat = 0;             // Client format of the current storage
+
+    GLuint pbos[PBO_COUNT] = {};
+    int nextPbo = 0;                  // Ring position of the next upload
+
+    void uploadDirect(const cv::Mat& image, GLenum format);
+    void uploadThroughPbo(const cv::Mat& image, GLenum format);
+};
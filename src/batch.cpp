@@ -0,0 +1,369 @@
+// Headless batch runner: evaluates a node graph over many images without
+// any window or OpenGL context.
+//
+//   NodeBatch [-g <graph file>] [-o <output dir>] [-j <threads>] [--parallel auto|images|intra]
+//             [--tile <px>] [--buffer-budget <MB>] [--trace <trace.json>]
+//             [--cache <dir>] [--cache-budget <MB>]
+//             <image | video | directory | list.txt> ...
+//   NodeBatch --dump-graph <graph file>
+//
+// Directories are scanned (non-recursively) for image files; .txt arguments
+// are read as one image path per line. Video files and image sequence
+// patterns (e.g. frames/img_%04d.png) are streamed frame by frame, with up
+// to <threads> frames in flight; each frame's outputs are numbered. Without
+// -g the editor's default pipeline is used; --dump-graph writes it out as a
+// starting point.
+//
+// --parallel picks how the threads are spent: "images" gives every thread
+// its own copy of the graph and image (best for many small photos),
+// "intra" runs one image at a time with every thread inside it (best for
+// a few large ones). "auto", the default, uses images when there are at
+// least as many images as threads.
+// --tile runs chains of tileable nodes in <px>-sized tiles, so their
+// intermediates never exist at full resolution (for very large images).
+// --buffer-budget caps the free image buffers kept for reuse, in total
+// across all workers (default 1024 MB).
+// --trace records per-node timings of the last passes of every worker as a
+// Chrome trace. --cache keeps expensive intermediate results in <dir>, so
+// a restarted job reloads them instead of recomputing; --cache-budget caps
+// the directory's size (default 4096 MB, 0 for no limit), deleting the
+// oldest results first.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "../nodes/ImageInputNode.h"
+#include "../nodes/BrightnessContrastNode.h"
+#include "../nodes/OutputNode.h"
+#include "../nodes/ColorChannelSplitterNode.h"
+#include "../nodes/BlurNode.h"
+#include "../nodes/ThresholdNode.h"
+#include "../nodes/EdgeDetectionNode.h"
+#include "../GraphEngine.h"
+#include "../Graph.h"
+#include "../GraphIO.h"
+#include "../ImageWriteQueue.h"
+#include "../FramePipeline.h"
+
+namespace fs = std::filesystem;
+
+// Same pipeline as the editor's default graph
+static std::unique_ptr<Graph> buildDefaultGraph() {
+    auto graph = std::make_unique<Graph>();
+
+    ImageInputNode* inputNode = graph->add<ImageInputNode>();
+    BrightnessContrastNode* bcNode = graph->add<BrightnessContrastNode>(1.0, 0);
+    bcNode->inputs.push_back(inputNode);
+
+    BlurNode* blurNode = graph->add<BlurNode>(5, false);
+    blurNode->inputs.push_back(bcNode);
+
+    ThresholdNode* thresholdNode = graph->add<ThresholdNode>(128, ThresholdNode::BINARY);
+    thresholdNode->inputs.push_back(blurNode);
+
+    EdgeDetectionNode* edgeNode = graph->add<EdgeDetectionNode>(EdgeDetectionNode::SOBEL);
+    edgeNode->inputs.push_back(thresholdNode);
+
+    ColorChannelSplitterNode* splitter = graph->add<ColorChannelSplitterNode>(true);
+    splitter->inputs.push_back(thresholdNode);
+
+    OutputNode* outputFull = graph->add<OutputNode>("output_full", "jpg", 90);
+    outputFull->inputs.push_back(edgeNode);
+
+    OutputNode* outputChannel = graph->add<OutputNode>("output_channel", "jpg", 90);
+    outputChannel->inputs.push_back(splitter);
+
+    graph->sinks = { outputFull, outputChannel };
+    return graph;
+}
+
+static bool isImageFile(const fs::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp"
+        || ext == ".tif" || ext == ".tiff" || ext == ".webp";
+}
+
+static bool isVideoSource(const std::string& arg) {
+    if (arg.find('%') != std::string::npos) return true;  // Numbered image sequence
+    std::string ext = fs::path(arg).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".mp4" || ext == ".avi" || ext == ".mov" || ext == ".mkv"
+        || ext == ".webm" || ext == ".m4v" || ext == ".mpg" || ext == ".mpeg";
+}
+
+static void collectInputs(const std::string& arg, std::vector<std::string>& files, std::vector<std::string>& videos) {
+    fs::path p(arg);
+    if (isVideoSource(arg)) {
+        videos.push_back(arg);
+    } else if (fs::is_directory(p)) {
+        std::vector<std::string> found;
+        for (const auto& entry : fs::directory_iterator(p)) {
+            if (entry.is_regular_file() && isImageFile(entry.path()))
+                found.push_back(entry.path().string());
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    } else if (p.extension() == ".txt") {
+        std::ifstream list(arg);
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) files.push_back(line);
+        }
+    } else {
+        files.push_back(arg);
+    }
+}
+
+static void printUsage() {
+    std::cerr << "Usage: NodeBatch [-g <graph file>] [-o <output dir>] [-j <threads>] [--parallel auto|images|intra]\n"
+              << "                 [--tile <px>] [--buffer-budget <MB>] [--trace <trace.json>]\n"
+              << "                 [--cache <dir>] [--cache-budget <MB>]\n"
+              << "                 <image | video | directory | list.txt> ...\n"
+              << "       NodeBatch --dump-graph <graph file>\n";
+}
+
+int main(int argc, char** argv) {
+    std::string outputDir = ".";
+    std::string graphFile;
+    std::string traceFile;
+    std::string cacheDir;
+    size_t cacheBudget = size_t(4096) << 20;
+    std::string parallel = "auto";
+    int tileSize = 0;
+    size_t bufferBudget = size_t(1024) << 20;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> files, videos;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-g" || arg == "--graph") && i + 1 < argc) {
+            graphFile = argv[++i];
+        } else if (arg == "--dump-graph" && i + 1 < argc) {
+            if (!saveGraphFile(*buildDefaultGraph(), argv[++i])) {
+                std::cerr << "[✘] Could not write " << argv[i] << std::endl;
+                return 1;
+            }
+            return 0;
+        } else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else if (arg == "--tile" && i + 1 < argc) {
+            tileSize = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--buffer-budget" && i + 1 < argc) {
+            bufferBudget = static_cast<size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "--cache-budget" && i + 1 < argc) {
+            cacheBudget = static_cast<size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--parallel" && i + 1 < argc) {
+            parallel = argv[++i];
+            if (parallel != "auto" && parallel != "images" && parallel != "intra") {
+                printUsage();
+                return 1;
+            }
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            collectInputs(arg, files, videos);
+        }
+    }
+
+    if (files.empty() && videos.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (!traceFile.empty())
+        profiling::installAllocationCounter();  // While this is the only thread
+
+    // Load the pipeline once up front so errors show before any work starts;
+    // workers run clones of it
+    std::unique_ptr<Graph> prototype;
+    if (graphFile.empty()) {
+        prototype = buildDefaultGraph();
+    } else {
+        GraphLoadOptions loadOptions;
+        loadOptions.loadImages = false;
+        try {
+            prototype = loadGraphFile(graphFile, loadOptions);
+        } catch (const std::exception& e) {
+            std::cerr << "[✘] " << graphFile << ": " << e.what() << std::endl;
+            return 1;
+        }
+        if (!prototype->find<ImageInputNode>()) {
+            std::cerr << "[✘] Graph has no ImageInput node" << std::endl;
+            return 1;
+        }
+    }
+
+    fs::create_directories(outputDir);
+    // One cache for every engine, so the budget covers all of them
+    std::shared_ptr<DiskCache> diskCache;
+    if (!cacheDir.empty())
+        diskCache = std::make_shared<DiskCache>(cacheDir, cacheBudget);
+    if (diskCache && !diskCache->isOpen()) {
+        std::cerr << "[✘] Could not use cache directory " << cacheDir << std::endl;
+        return 1;
+    }
+
+    // Nodes keep their results as members, so every worker owns a graph
+    std::vector<std::unique_ptr<Graph>> graphs;
+    auto makeGraph = [&prototype]() { return prototype->clone(); };
+
+    // Images in parallel: one worker per thread, each evaluating its graph on
+    // one thread. Intra-image: a single worker whose engine and OpenCV
+    // kernels use all threads.
+    bool imagesInParallel = parallel == "images" || (parallel == "auto" && files.size() >= threads);
+    unsigned workers = imagesInParallel ? std::min<unsigned>(threads, static_cast<unsigned>(files.size()))
+                                        : std::min<unsigned>(1, static_cast<unsigned>(files.size()));
+    unsigned engineThreads = imagesInParallel ? 1 : threads;
+    try {
+        for (unsigned w = 0; w < workers; ++w)
+            graphs.push_back(makeGraph());
+    } catch (const std::exception& e) {
+        std::cerr << "[✘] " << e.what() << std::endl;
+        return 1;
+    }
+
+    // With one image (or frame) per worker, OpenCV's own threading would
+    // only oversubscribe the cores; a single worker gets all of them. Set per
+    // phase, since the video phase below runs one frame per lane.
+    cv::setNumThreads(imagesInParallel && workers > 1 ? 1 : static_cast<int>(threads));
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed{0};
+    std::mutex logMutex;
+    std::vector<PassProfile> trace;  // Guarded by logMutex
+
+    // Settings shared by every worker's and every video lane's engine; the
+    // buffer budget is split between the `engines` running at once
+    auto configure = [&](GraphEngine& engine, unsigned engines) {
+        engine.setTileSize(tileSize);
+        engine.setBufferBudget(bufferBudget / std::max(1u, engines));
+        engine.setProfiling(!traceFile.empty());
+        if (diskCache)
+            engine.setDiskCache(diskCache);
+    };
+
+    auto worker = [&](Graph* graph) {
+        // Every image recomputes the whole graph, so nothing is lost by freeing
+        // intermediates as soon as they are consumed
+        GraphEngine engine(engineThreads);
+        engine.setReleaseIntermediates(true);
+        configure(engine, workers);
+
+        ImageInputNode* input = graph->find<ImageInputNode>();
+        std::vector<OutputNode*> outputs = graph->findAll<OutputNode>();
+        std::vector<std::string> baseNames;
+        for (OutputNode* out : outputs)
+            baseNames.push_back(out->getFilename());
+
+        for (size_t i = next++; i < files.size(); i = next++) {
+            const std::string& file = files[i];
+            cv::Mat image = cv::imread(file);
+            if (image.empty()) {
+                std::lock_guard<std::mutex> lock(logMutex);
+                std::cerr << "[✘] Could not read " << file << std::endl;
+                ++failed;
+                continue;
+            }
+
+            std::string stem = fs::path(file).stem().string();
+            for (size_t k = 0; k < outputs.size(); ++k)
+                outputs[k]->setFilename((fs::path(outputDir) / (stem + "_" + baseNames[k])).string());
+
+            input->setImage(image, file);
+            try {
+                engine.execute(graph->sinks);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(logMutex);
+                std::cerr << "[✘] " << file << ": " << e.what() << std::endl;
+                ++failed;
+            }
+        }
+
+        if (engine.getProfiling()) {
+            std::vector<PassProfile> passes = engine.profileHistory();
+            std::lock_guard<std::mutex> lock(logMutex);
+            trace.insert(trace.end(), passes.begin(), passes.end());
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; ++w)
+        pool.emplace_back(worker, graphs[w].get());
+    for (std::thread& t : pool)
+        t.join();
+
+    // Videos are streamed one after another, each with `threads` frames in flight
+    size_t frames = 0, failedFrames = 0, failedVideos = 0;
+    std::vector<std::string> baseNames;
+    for (OutputNode* out : prototype->findAll<OutputNode>())
+        baseNames.push_back(out->getFilename());
+
+    for (const std::string& video : videos) {
+        FrameReader reader(video, 2 * threads);
+        if (!reader.isOpened()) {
+            std::cerr << "[✘] Could not open " << video << std::endl;
+            ++failedVideos;
+            continue;
+        }
+
+        FramePipeline pipeline(makeGraph, threads);
+        cv::setNumThreads(pipeline.laneCount() > 1 ? 1 : static_cast<int>(threads));
+        for (unsigned lane = 0; lane < pipeline.laneCount(); ++lane)
+            configure(pipeline.engine(lane), pipeline.laneCount());
+
+        std::string stem = fs::path(video).stem().string();
+        stem.erase(std::remove(stem.begin(), stem.end(), '%'), stem.end());
+        auto nameOutputs = [&](long index, Graph& graph) {
+            char number[16];
+            std::snprintf(number, sizeof(number), "%06ld", index);
+            std::vector<OutputNode*> outputs = graph.findAll<OutputNode>();
+            for (size_t k = 0; k < outputs.size(); ++k)
+                outputs[k]->setFilename((fs::path(outputDir) / (stem + "_" + number + "_" + baseNames[k])).string());
+        };
+
+        FramePipeline::Result result = pipeline.run(reader, nameOutputs);
+        frames += result.frames;
+        failedFrames += result.failed;
+
+        for (unsigned lane = 0; lane < pipeline.laneCount() && !traceFile.empty(); ++lane) {
+            std::vector<PassProfile> passes = pipeline.engine(lane).profileHistory();
+            trace.insert(trace.end(), passes.begin(), passes.end());
+        }
+    }
+
+    // Output nodes only queue their writes; wait for the encoders to drain
+    size_t writeFailures = ImageWriteQueue::shared().flush();
+    if (diskCache)
+        diskCache->flush();
+
+    if (!traceFile.empty() && !profiling::writeChromeTraceFile(trace, traceFile))
+        std::cerr << "[✘] Could not write " << traceFile << std::endl;
+
+    if (!files.empty())
+        std::cout << "Processed " << files.size() - failed << "/" << files.size() << " images" << std::endl;
+    if (!videos.empty())
+        std::cout << "Processed " << frames - failedFrames << "/" << frames << " frames from "
+                  << videos.size() - failedVideos << "/" << videos.size() << " videos" << std::endl;
+    if (writeFailures > 0)
+        std::cerr << "[✘] " << writeFailures << " output file(s) could not be written" << std::endl;
+    return failed == 0 && failedFrames == 0 && failedVideos == 0 && writeFailures == 0 ? 0 : 2;
+}
@@ -1,10 +1,6 @@
 #include <iostream>
 #include <opencv2/opencv.hpp>
 
-#ifndef GL_BGR
-#define GL_BGR 0x80E0
-#endif
-
 #include "../nodes/ImageInputNode.h"
 #include "../nodes/BrightnessContrastNode.h"
 #include "../nodes/OutputNode.h"
@@ -13,6 +9,8 @@
 #include "../nodes/ThresholdNode.h"
 #include "../nodes/EdgeDetectionNode.h" // ✅ Edge Detection Node
 #include "../GraphEngine.h"
+#include "../LiveEvaluator.h"
+#include "PreviewTexture.h"  // Includes glad, which must come before any other GL header
 
 // GUI
 #include "imgui.h"
@@ -20,28 +18,21 @@
 #include "imgui_impl_opengl3.h"
 
 #include <GLFW/glfw3.h>
-#include <unordered_set>
-
-// OpenGL Texture
-GLuint matToTexture(const cv::Mat& mat) {
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    GLint format = mat.channels() == 3 ? GL_BGR : GL_LUMINANCE;
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, mat.cols, mat.rows, 0, format, GL_UNSIGNED_BYTE, mat.data);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    return textureID;
-}
+#include <tuple>
 
 int main() {
+    // Before any thread allocates, so the profiler can be switched on later
+    profiling::installAllocationCounter();
+
     // Initialize GLFW
     if (!glfwInit()) return -1;
     GLFWwindow* window = glfwCreateWindow(1280, 720, "Node Editor GUI", NULL, NULL);
     glfwMakeContextCurrent(window);
     glfwSwapInterval(1);
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+        std::cerr << "[✘] Failed to load OpenGL functions" << std::endl;
+        return -1;
+    }
 
     // Initialize ImGui
     IMGUI_CHECKVERSION();
@@ -75,7 +66,14 @@ int main() {
     OutputNode* outputChannel = new OutputNode("output_channel", "jpg", 90);
     outputChannel->inputs.push_back(splitter);
 
+    std::vector<Node*> allNodes = { inputNode, bcNode, blurNode, thresholdNode, edgeNode,
+                                    splitter, outputFull, outputChannel };
+
     GraphEngine engine;
+    // Flipping a parameter back restores the earlier result instead of recomputing it
+    engine.setCacheBudget(size_t(512) << 20);
+    // Owns the nodes from here on: everything that touches them is posted to it
+    LiveEvaluator live(engine);
 
     // UI State
     float brightness = 0.0f;
@@ -83,6 +81,7 @@ int main() {
     bool useChannelOutput = false;
     int blurRadius = 5;
     bool directionalBlur = false;
+    int blurMode = BlurNode::GAUSSIAN;
     float thresholdValue = 128.0f;
     int thresholdMethod = ThresholdNode::BINARY;
 
@@ -90,9 +89,69 @@ int main() {
     int sobelKernelSize = 3;
     float cannyThreshold1 = 100.0f, cannyThreshold2 = 200.0f;
     bool overlayEdges = false;
+    bool grayscaleOutput = splitter->getGrayscaleOutput();
+    bool livePreview = true;
+    bool proxyPreview = true;
+    bool diskCacheOn = false;
+    bool tiledOn = false;
+    const double PROXY_PIXELS = 2e6;  // Proxy previews stay at or below about 2 MP
+    std::string loadedImage = inputNode->getFilename();
+
+    // Hand the panel values to the nodes whenever any of them changed
+    auto currentParameters = [&] {
+        return std::make_tuple(brightness, contrast, blurRadius, directionalBlur, blurMode,
+                               thresholdValue, thresholdMethod, edgeMethod, sobelKernelSize,
+                               cannyThreshold1, cannyThreshold2, overlayEdges, grayscaleOutput,
+                               proxyPreview);
+    };
+    // Runs on the evaluation thread: tuning happens on a downscaled proxy,
+    // processing and saving at full resolution
+    auto setPreviewLevel = [allNodes](int level) {
+        for (Node* node : allNodes) node->setPreviewLevel(level);
+    };
+    auto postedParameters = currentParameters();
+    bool parametersPosted = false;  // The first sync also picks the initial proxy level
+    auto syncParameters = [&] {
+        if (parametersPosted && currentParameters() == postedParameters) return;
+        postedParameters = currentParameters();
+        parametersPosted = true;
+        live.post([=] {
+            bcNode->setParameters(contrast, brightness);
+            blurNode->setParameters(blurRadius, directionalBlur);
+            blurNode->setMode(static_cast<BlurNode::Mode>(blurMode));
+            thresholdNode->setParameters(thresholdValue, thresholdMethod);
+            edgeNode->setParameters(static_cast<EdgeDetectionNode::Method>(edgeMethod), // Cast to enum
+                                    sobelKernelSize, cannyThreshold1, cannyThreshold2, overlayEdges);
+            splitter->setGrayscaleOutput(grayscaleOutput);
+            setPreviewLevel(proxyPreview ? inputNode->proxyLevel(PROXY_PIXELS) : 0);
+        });
+    };
+    // Evaluate an output node at full resolution (which also writes its file)
+    // and show the result; saving then waits for the write to finish. Live
+    // previews go back to the proxy afterwards.
+    auto processOutput = [&](OutputNode* output, bool save) {
+        syncParameters();
+        live.post([&engine, &live, setPreviewLevel, inputNode, PROXY_PIXELS, proxy = proxyPreview, output, save] {
+            int previewLevel = proxy ? inputNode->proxyLevel(PROXY_PIXELS) : 0;
+            setPreviewLevel(0);
+            try {
+                engine.execute(output);
+                live.publish(output);
+                if (save) output->save();
+            } catch (...) {
+                setPreviewLevel(previewLevel);
+                throw;
+            }
+            setPreviewLevel(previewLevel);
+        });
+    };
 
-    GLuint texID = 0;
+    // One texture per output, reused across frames
+    PreviewTexture fullPreview, channelPreview;
+    PreviewTexture* shownPreview = nullptr;
     cv::Mat processed;
+    Node* processedSource = nullptr;
+    unsigned long long processedSequence = 0;
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
@@ -107,20 +166,19 @@ int main() {
         ImGui::SliderFloat("Brightness", &brightness, -100.0f, 100.0f);
         ImGui::SliderFloat("Contrast", &contrast, 0.0f, 3.0f);
         ImGui::Checkbox("Show Channel Output", &useChannelOutput);
+        ImGui::Checkbox("Live Preview", &livePreview);
+        ImGui::Checkbox("Proxy Resolution", &proxyPreview);
+        if (live.busy())
+            ImGui::Text("Evaluating...");
             
         // Threshold Controls
         ImGui::SliderFloat("Threshold Value", &thresholdValue, 0.0f, 255.0f);
         const char* thresholdMethods[] = { "Binary", "Adaptive", "Otsu" };
-        if (ImGui::Combo("Threshold Method", &thresholdMethod, thresholdMethods, IM_ARRAYSIZE(thresholdMethods))) {
-            thresholdNode->setParameters(thresholdValue, thresholdMethod);
-        }
+        ImGui::Combo("Threshold Method", &thresholdMethod, thresholdMethods, IM_ARRAYSIZE(thresholdMethods));
         
         // Edge Detection Controls
         const char* edgeMethods[] = { "Sobel", "Canny" };
-        if (ImGui::Combo("Edge Method", &edgeMethod, edgeMethods, IM_ARRAYSIZE(edgeMethods))) {
-            edgeNode->setParameters(static_cast<EdgeDetectionNode::Method>(edgeMethod), // Cast to enum
-                                    sobelKernelSize, cannyThreshold1, cannyThreshold2, overlayEdges);
-        }
+        ImGui::Combo("Edge Method", &edgeMethod, edgeMethods, IM_ARRAYSIZE(edgeMethods));
 
         // Ensure Sobel kernel size is odd and <= 31
         if (edgeMethod == EdgeDetectionNode::SOBEL) {
@@ -138,36 +196,11 @@ int main() {
         ImGui::Checkbox("Overlay Edges", &overlayEdges);
         
         if (ImGui::Button("Process Image")) {
-            bcNode->setParameters(contrast, brightness);
-            blurNode->setParameters(blurRadius, directionalBlur);
-            thresholdNode->setParameters(thresholdValue, thresholdMethod);
-            edgeNode->setParameters(static_cast<EdgeDetectionNode::Method>(edgeMethod), // Cast to enum
-                                    sobelKernelSize, cannyThreshold1, cannyThreshold2, overlayEdges);
-        
-            std::unordered_set<Node*> visited;
-        
-            if (useChannelOutput) {
-                engine.execute(outputChannel, visited);
-                processed = outputChannel->getOutput();
-            } else {
-                engine.execute(outputFull, visited);
-                processed = outputFull->getOutput();
-            }
-        
-            if (!processed.empty()) {
-                texID = matToTexture(processed);
-                if (useChannelOutput)
-                    outputChannel->showPreview();
-                else
-                    outputFull->showPreview();
-            }
+            processOutput(useChannelOutput ? outputChannel : outputFull, false);
         }
         
         if (ImGui::Button("Save Output")) {
-            if (useChannelOutput)
-                outputChannel->save();
-            else
-                outputFull->save();
+            processOutput(useChannelOutput ? outputChannel : outputFull, true);
         }
         
         ImGui::End();
@@ -175,9 +208,12 @@ int main() {
         // === Image Input Node UI ===
         ImGui::Begin("📷 Image Input");
         if (ImGui::Button("Reload Image")) {
-            inputNode->reload(inputNode->getFilename().c_str());
+            live.post([=] {
+                inputNode->reload(loadedImage.c_str());
+                setPreviewLevel(proxyPreview ? inputNode->proxyLevel(PROXY_PIXELS) : 0);
+            });
         }
-        ImGui::Text("Loaded: %s", inputNode->getFilename().c_str());
+        ImGui::Text("Loaded: %s", loadedImage.c_str());
         ImGui::End();
 
         // === Brightness & Contrast Node UI ===
@@ -190,26 +226,23 @@ int main() {
         ImGui::Begin("🌀 Blur Node");
         ImGui::SliderInt("Radius", &blurRadius, 1, 20);
         ImGui::Checkbox("Directional (Horizontal Only)", &directionalBlur);
+        const char* blurModes[] = { "Gaussian", "Fast Box Approx." };
+        ImGui::Combo("Blur Engine", &blurMode, blurModes, IM_ARRAYSIZE(blurModes));
         if (ImGui::Button("Preview Kernel")) {
-            blurNode->setParameters(blurRadius, directionalBlur);
-            blurNode->showKernelPreview();
+            syncParameters();
+            live.post([blurNode] { blurNode->showKernelPreview(); });
         }
         ImGui::End();
 
         // === 🔲 Threshold Node UI ===
         ImGui::Begin("🔲 Threshold Node");
         ImGui::SliderFloat("Threshold Value", &thresholdValue, 0.0f, 255.0f);
-        if (ImGui::Combo("Threshold Method", &thresholdMethod, thresholdMethods, IM_ARRAYSIZE(thresholdMethods))) {
-            thresholdNode->setParameters(thresholdValue, thresholdMethod);
-        }
+        ImGui::Combo("Threshold Method", &thresholdMethod, thresholdMethods, IM_ARRAYSIZE(thresholdMethods));
         ImGui::End();
 
         // === 🪞 Edge Detection Node UI ===
         ImGui::Begin("🪞 Edge Detection Node");
-        if (ImGui::Combo("Edge Method", &edgeMethod, edgeMethods, IM_ARRAYSIZE(edgeMethods))) {
-            edgeNode->setParameters(static_cast<EdgeDetectionNode::Method>(edgeMethod), // Cast to enum
-                                    sobelKernelSize, cannyThreshold1, cannyThreshold2, overlayEdges);
-        }
+        ImGui::Combo("Edge Method", &edgeMethod, edgeMethods, IM_ARRAYSIZE(edgeMethods));
         if (edgeMethod == EdgeDetectionNode::SOBEL) {
             ImGui::SliderInt("Sobel Kernel Size", &sobelKernelSize, 1, 7);
         } else {
@@ -222,33 +255,90 @@ int main() {
         // === 🎨 Channel Splitter UI ===
         ImGui::Begin("🎨 Channel Splitter");
         ImGui::Text("Outputs RGB/RGBA channels as grayscale");
-        bool grayscale = splitter->getGrayscaleOutput();
-        if (ImGui::Checkbox("Grayscale Output", &grayscale)) {
-            splitter->setGrayscaleOutput(grayscale);
-        }
+        ImGui::Checkbox("Grayscale Output", &grayscaleOutput);
         ImGui::End();
 
         // === 💾 Output Node UI ===
         ImGui::Begin("💾 Output");
         if (ImGui::Button("Process Image")) {
-            bcNode->setParameters(contrast, brightness);
-            blurNode->setParameters(blurRadius, directionalBlur);
-            thresholdNode->setParameters(thresholdValue, thresholdMethod);
-            edgeNode->setParameters(static_cast<EdgeDetectionNode::Method>(edgeMethod), // Cast to enum
-                                    sobelKernelSize, cannyThreshold1, cannyThreshold2, overlayEdges);
+            processOutput(useChannelOutput ? outputChannel : outputFull, false);
+        }
+        ImGui::End();
+
+        // Live mode previews what feeds the selected output, without writing files
+        syncParameters();
+        OutputNode* shownOutput = useChannelOutput ? outputChannel : outputFull;
+        live.setTarget(livePreview ? shownOutput->inputs[0] : nullptr);
 
-            std::unordered_set<Node*> visited;
-            if (useChannelOutput)
-                engine.execute(outputChannel, visited);
+        if (live.fetch(processed, processedSource, processedSequence) && !processed.empty()) {
+            shownPreview = useChannelOutput ? &channelPreview : &fullPreview;
+            shownPreview->upload(processed);
+            if (processedSource == outputFull || processedSource == outputChannel)
+                OutputNode::showPreview(processed);
+        }
+
+        // === ⏱ Profiler UI ===
+        ImGui::Begin("⏱ Profiler");
+        bool profilingOn = engine.getProfiling();
+        if (ImGui::Checkbox("Record Timings", &profilingOn))
+            engine.setProfiling(profilingOn);
+        ImGui::SameLine();
+        if (ImGui::Button("Export Trace")) {
+            if (profiling::writeChromeTraceFile(engine.profileHistory(), "profile_trace.json"))
+                std::cout << "[✔] Trace written to profile_trace.json" << std::endl;
             else
-                engine.execute(outputFull, visited);
+                std::cerr << "[✘] Could not write profile_trace.json" << std::endl;
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Clear"))
+            engine.clearProfiles();
+
+        const OutputCache& cache = engine.outputCache();
+        ImGui::Text("Result cache: %zu hits, %zu misses, %.0f / %.0f MB", cache.hits(), cache.misses(),
+                    cache.cachedBytes() / 1048576.0, cache.budgetBytes() / 1048576.0);
+
+        // Expensive results survive restarts; the engine is only touched between passes
+        if (ImGui::Checkbox("Disk Cache (.nodecache)", &diskCacheOn)) {
+            bool enable = diskCacheOn;
+            live.post([&engine, enable] {
+                if (!enable)
+                    engine.disableDiskCache();
+                else if (!engine.setDiskCache(".nodecache", size_t(4) << 30))
+                    std::cerr << "[✘] Could not use .nodecache" << std::endl;
+            });
+        }
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Tiled (512 px)", &tiledOn)) {
+            int tileSize = tiledOn ? 512 : 0;
+            live.post([&engine, tileSize] { engine.setTileSize(tileSize); });
+        }
+
+        PassProfile lastPass = engine.lastProfile();
+        ImGui::Text("Pass %llu: %.1f ms, %d node(s) ran", lastPass.index, lastPass.wallMs,
+                    static_cast<int>(lastPass.nodes.size()));
+        if (ImGui::BeginTable("profile", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable)) {
+            ImGui::TableSetupColumn("Node");
+            ImGui::TableSetupColumn("Wall ms");
+            ImGui::TableSetupColumn("CPU ms");
+            ImGui::TableSetupColumn("Output MB");
+            ImGui::TableSetupColumn("Alloc MB");
+            ImGui::TableHeadersRow();
+            for (const NodeProfile& node : lastPass.nodes) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("%s", node.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", node.wallMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", node.cpuMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", node.outputBytes / 1048576.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", node.allocatedBytes / 1048576.0);
+            }
+            ImGui::EndTable();
         }
         ImGui::End();
 
         // === Render and Swap Buffers ===
         glClear(GL_COLOR_BUFFER_BIT);
-        if (texID != 0) {
-            glBindTexture(GL_TEXTURE_2D, texID);
+        if (shownPreview && shownPreview->id() != 0) {
+            glBindTexture(GL_TEXTURE_2D, shownPreview->id());
             glBegin(GL_QUADS);
             glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
             glTexCoord2f(1.0f, 0.0f); glVertex2f(1.0f, -1.0f);
@@ -262,7 +352,9 @@ int main() {
         glfwSwapBuffers(window);
     }
 
-    // Cleanup
+    // Cleanup; textures go while the context is still alive
+    fullPreview.release();
+    channelPreview.release();
     glfwDestroyWindow(window);
     glfwTerminate();
 
@@ -0,0 +1,33 @@
+#pragma once
+#include <opencv2/core.hpp>
+#include <iostream>
+
+// Minimal assertions for the test executables: failures are reported and
+// counted, and main() returns the count so CTest sees the result.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" \
+                      << std::endl;                                                       \
+            ++checkFailures();                                                            \
+        }                                                                                 \
+    } while (0)
+
+// Same size, type and every pixel
+inline bool identical(const cv::Mat& a, const cv::Mat& b) {
+    return !a.empty() && a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0;
+}
+
+// Deterministic noise, smoothed a little so thresholds and edges have structure
+inline cv::Mat testImage(int width, int height, int type = CV_8UC3) {
+    cv::Mat image(height, width, type);
+    cv::RNG rng(0x7e57);
+    rng.fill(image, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::blur(image, image, cv::Size(3, 3));
+    return image;
+}
@@ -0,0 +1,50 @@
+// Fused point-wise chains must give exactly the unfused result: composing
+// brightness/contrast and binary threshold lookup tables into one may not
+// change a single 8-bit value.
+
+#include "Check.h"
+#include "../Graph.h"
+#include "../GraphEngine.h"
+#include "../nodes/ImageInputNode.h"
+#include "../nodes/BrightnessContrastNode.h"
+#include "../nodes/ThresholdNode.h"
+
+namespace {
+
+// input -> brightness/contrast -> brightness/contrast -> binary threshold
+cv::Mat evaluate(const cv::Mat& image, double alpha, int beta, double threshold, bool fusion) {
+    Graph graph;
+    ImageInputNode* input = graph.add<ImageInputNode>();
+    input->setImage(image);
+    BrightnessContrastNode* first = graph.add<BrightnessContrastNode>(alpha, beta);
+    first->connect(input);
+    BrightnessContrastNode* second = graph.add<BrightnessContrastNode>(1.0 / alpha, -beta / 2);
+    second->connect(first);
+    ThresholdNode* binary = graph.add<ThresholdNode>(threshold, ThresholdNode::BINARY);
+    binary->connect(second);
+
+    GraphEngine engine(2);
+    engine.setFusion(fusion);
+    engine.execute(binary);
+    return binary->getOutput();
+}
+
+} // namespace
+
+int main() {
+    for (int type : { CV_8UC1, CV_8UC3 }) {
+        cv::Mat image = testImage(257, 131, type);
+        // Saturating, fractional and identity-like settings, thresholds on
+        // and between integer levels
+        for (double alpha : { 0.35, 1.0, 1.7, 3.0 }) {
+            for (int beta : { -60, 0, 25 }) {
+                for (double threshold : { 0.0, 97.5, 128.0, 254.0 })
+                    CHECK(identical(evaluate(image, alpha, beta, threshold, true),
+                                    evaluate(image, alpha, beta, threshold, false)));
+            }
+        }
+    }
+
+    if (checkFailures() == 0) std::cout << "FusionTest passed" << std::endl;
+    return checkFailures();
+}
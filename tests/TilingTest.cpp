@@ -0,0 +1,63 @@
+// Tiled evaluation must give exactly the untiled result: a chain of
+// tileable nodes run tile by tile, with each tile padded by the chain's
+// halo, may not leave seams along the tile borders.
+
+#include "Check.h"
+#include "../Graph.h"
+#include "../GraphEngine.h"
+#include "../nodes/ImageInputNode.h"
+#include "../nodes/BrightnessContrastNode.h"
+#include "../nodes/BlurNode.h"
+#include "../nodes/ThresholdNode.h"
+#include "../nodes/EdgeDetectionNode.h"
+
+namespace {
+
+struct Chain {
+    BlurNode::Mode blurMode;
+    int thresholdMethod;
+    int sobelKernelSize;
+    int imageType;
+};
+
+// input -> brightness/contrast -> blur -> threshold -> Sobel, all one chain
+cv::Mat evaluate(const Chain& chain, const cv::Mat& image, int tileSize) {
+    Graph graph;
+    ImageInputNode* input = graph.add<ImageInputNode>();
+    input->setImage(image);
+    BrightnessContrastNode* bc = graph.add<BrightnessContrastNode>(1.3, -20);
+    bc->connect(input);
+    BlurNode* blur = graph.add<BlurNode>(4, false);
+    blur->setMode(chain.blurMode);
+    blur->connect(bc);
+    ThresholdNode* threshold = graph.add<ThresholdNode>(110, chain.thresholdMethod);
+    threshold->connect(blur);
+    EdgeDetectionNode* edges = graph.add<EdgeDetectionNode>(EdgeDetectionNode::SOBEL, chain.sobelKernelSize);
+    edges->connect(threshold);
+
+    GraphEngine engine(2);
+    engine.setTileSize(tileSize);
+    engine.execute(edges);
+    return edges->getOutput();
+}
+
+} // namespace
+
+int main() {
+    const Chain chains[] = {
+        { BlurNode::GAUSSIAN, ThresholdNode::BINARY, 3, CV_8UC3 },
+        { BlurNode::GAUSSIAN, ThresholdNode::BINARY, 1, CV_8UC3 },  // 1-tap Sobel still reads its neighbours
+        { BlurNode::BOX_APPROX, ThresholdNode::BINARY, 5, CV_8UC3 },
+        { BlurNode::GAUSSIAN, ThresholdNode::ADAPTIVE, 3, CV_8UC1 },  // Adaptive takes one channel
+    };
+    for (const Chain& chain : chains) {
+        // Neither side a multiple of the tile size, so edge tiles are partial
+        cv::Mat image = testImage(301, 203, chain.imageType);
+        cv::Mat untiled = evaluate(chain, image, 0);
+        for (int tileSize : { 16, 64, 1000 })
+            CHECK(identical(evaluate(chain, image, tileSize), untiled));
+    }
+
+    if (checkFailures() == 0) std::cout << "TilingTest passed" << std::endl;
+    return checkFailures();
+}